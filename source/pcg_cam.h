@@ -0,0 +1,33 @@
+#if !defined(PCG_CAM_H)
+#define PCG_CAM_H
+/*
+    ==========================================================================
+    File: pcg_cam.h
+    Date: 18/10/2026
+    ==========================================================================
+
+    Shared types and macros for the platform-independent parts of the utility. Anything
+    included from here must not depend on Windows.h, so it can be compiled (and checked)
+    on any platform.
+*/
+
+#include <stdint.h>
+
+#define globalvar static
+#define internal static
+#define localpersist static
+
+typedef uint8_t   u8;
+typedef uint16_t  u16;
+typedef uint32_t  u32;
+typedef uint64_t  u64;
+typedef int32_t   i32;
+typedef int64_t   i64;
+typedef uint32_t  b32;
+typedef float     r32;
+typedef double    r64;
+
+#define Min(A, B) ((A) < (B) ? (A) : (B))
+#define Max(A, B) ((A) > (B) ? (A) : (B))
+
+#endif
@@ -0,0 +1,114 @@
+#if !defined(PCG_CANVAS_MAP_H)
+#define PCG_CANVAS_MAP_H
+/*
+    ==========================================================================
+    File: pcg_canvas_map.h
+    Date: 18/10/2026
+    ==========================================================================
+
+    Maps positions on the monitor (work area pixels) onto an OBS canvas of a different size,
+    e.g. a 1920 x 1080 canvas shown on a 2560 x 1440 monitor.
+
+    Edges are mapped, not distances: an edge at E maps to E * CanvasW / MonitorW, rounded to the
+    nearest canvas pixel (halves round up), using exact integer arithmetic. Since edge 0 and the
+    far edge map onto the canvas edges exactly, the left offset, width and right offset of a
+    mapped rectangle always add up to the canvas size.
+
+    The mapping for every edge position is tabled whenever the monitor or canvas changes, so
+    looking up an edge is a single load.
+*/
+
+#include "pcg_cam.h"
+#include <vector>
+
+/// A rectangle as edge positions (Right and Bottom are exclusive).
+struct canvas_rect
+{
+    i32 Left;
+    i32 Top;
+    i32 Right;
+    i32 Bottom;
+};
+
+struct canvas_map
+{
+    i32 MonitorW;
+    i32 MonitorH;
+    i32 CanvasW;
+    i32 CanvasH;
+
+    std::vector<i32> CanvasX; // NOTE: The canvas position of every monitor edge from 0 to MonitorW (inclusive)
+    std::vector<i32> CanvasY; // NOTE: The canvas position of every monitor edge from 0 to MonitorH (inclusive)
+};
+
+/// Maps a single edge position from a monitor axis of the given size onto a canvas axis, without any tables.
+internal i32 MapEdgeToCanvas(i32 Edge, i32 MonitorSize, i32 CanvasSize)
+{
+    // NOTE: round(Edge * CanvasSize / MonitorSize) == floor((2 * Edge * CanvasSize + MonitorSize) / (2 * MonitorSize)),
+    // which fits in 64 bits for any edge and size that fit in 32
+    i64 Numerator = 2 * (i64)Edge * (i64)CanvasSize + (i64)MonitorSize;
+    i64 Denominator = 2 * (i64)MonitorSize;
+    i64 Quotient = Numerator / Denominator;
+    if ((Numerator % Denominator) < 0)
+    {
+        --Quotient; // NOTE: Division truncates towards zero, so negative edges need flooring
+    }
+
+    return (i32)Quotient;
+}
+
+internal void BuildCanvasAxis(std::vector<i32> *Table, i32 MonitorSize, i32 CanvasSize)
+{
+    Table->resize((u32)MonitorSize + 1);
+    for (i32 Edge = 0; Edge <= MonitorSize; ++Edge)
+    {
+        (*Table)[Edge] = MapEdgeToCanvas(Edge, MonitorSize, CanvasSize);
+    }
+}
+
+/// Rebuilds the tables for a monitor/canvas pair. A canvas size of 0 uses the monitor size (no scaling).
+internal void BuildCanvasMap(canvas_map *Map, i32 MonitorW, i32 MonitorH, i32 CanvasW, i32 CanvasH)
+{
+    MonitorW = Max(MonitorW, 1);
+    MonitorH = Max(MonitorH, 1);
+    CanvasW = (CanvasW > 0) ? CanvasW : MonitorW;
+    CanvasH = (CanvasH > 0) ? CanvasH : MonitorH;
+
+    if (Map->MonitorW == MonitorW && Map->MonitorH == MonitorH &&
+        Map->CanvasW == CanvasW && Map->CanvasH == CanvasH)
+    {
+        return;
+    }
+
+    Map->MonitorW = MonitorW;
+    Map->MonitorH = MonitorH;
+    Map->CanvasW = CanvasW;
+    Map->CanvasH = CanvasH;
+    BuildCanvasAxis(&Map->CanvasX, MonitorW, CanvasW);
+    BuildCanvasAxis(&Map->CanvasY, MonitorH, CanvasH);
+}
+
+internal b32 IsCanvasMapScaled(const canvas_map *Map)
+{
+    return Map->MonitorW != Map->CanvasW || Map->MonitorH != Map->CanvasH;
+}
+
+/// Maps a batch of monitor rectangles onto the canvas. Rects and CanvasRects may be the same array.
+internal void MapRectsToCanvas(const canvas_map *Map, const canvas_rect *Rects, canvas_rect *CanvasRects, u32 Count)
+{
+    const i32 *CanvasX = Map->CanvasX.data();
+    const i32 *CanvasY = Map->CanvasY.data();
+    i32 MonitorW = Map->MonitorW;
+    i32 MonitorH = Map->MonitorH;
+
+    for (u32 RectIndex = 0; RectIndex < Count; ++RectIndex)
+    {
+        canvas_rect Rect = Rects[RectIndex];
+        CanvasRects[RectIndex].Left = CanvasX[Min(Max(Rect.Left, 0), MonitorW)];
+        CanvasRects[RectIndex].Top = CanvasY[Min(Max(Rect.Top, 0), MonitorH)];
+        CanvasRects[RectIndex].Right = CanvasX[Min(Max(Rect.Right, 0), MonitorW)];
+        CanvasRects[RectIndex].Bottom = CanvasY[Min(Max(Rect.Bottom, 0), MonitorH)];
+    }
+}
+
+#endif
@@ -0,0 +1,273 @@
+#if !defined(PCG_CURSOR_PREDICTOR_H)
+#define PCG_CURSOR_PREDICTOR_H
+/*
+    ==========================================================================
+    File: pcg_cursor_predictor.h
+    Date: 18/10/2026
+    ==========================================================================
+
+    Extrapolates the cursor to the time a frame is expected to be shown, so the selection corner
+    doesn't visibly lag behind the hardware cursor while dragging.
+
+    Two filters are available: a least-squares line through the most recent samples, and a
+    constant-velocity Kalman filter per axis (smoother with noisy/irregular samples). Either way
+    the prediction is limited in how far ahead (in time) and how far away (in pixels) from the
+    last real sample it may go, and it falls back to the last sample as soon as the samples stop
+    moving (the overlay keeps sampling the cursor every frame, so a stop shows up as repeated
+    positions rather than missing samples).
+
+    The prediction is for display only; the reported offsets always come from a real sample.
+*/
+
+#include "pcg_cam.h"
+#include <math.h>
+
+enum cursor_prediction_mode
+{
+    CursorPrediction_None,
+    CursorPrediction_Linear,
+    CursorPrediction_Kalman,
+};
+
+struct cursor_predictor_config
+{
+    cursor_prediction_mode Mode;
+    r64 MaxLeadSeconds;         // NOTE: Never extrapolate further ahead than this
+    r64 MaxOvershoot;           // NOTE: Never predict further than this many pixels from the last sample
+    r64 IdleSeconds;            // NOTE: No prediction once the cursor hasn't been sampled for this long
+    r64 StopSeconds;            // NOTE: No prediction once the sampled position hasn't changed for this long (or for
+                                //       twice the gap between the last two moves, if that's shorter)
+    u32 LinearSampleCount;      // NOTE: Samples fitted by the linear filter
+    r64 KalmanAccelerationNoise; // NOTE: Expected acceleration (px/s^2); higher follows direction changes faster
+    r64 KalmanMeasurementNoise;  // NOTE: Expected sample noise (px)
+};
+
+struct cursor_sample
+{
+    r64 Time;
+    r64 X;
+    r64 Y;
+};
+
+/// The state of one axis of the Kalman filter: position, velocity and their covariance.
+struct cursor_kalman_axis
+{
+    r64 Position;
+    r64 Velocity;
+    r64 P00;
+    r64 P01;
+    r64 P11;
+};
+
+const u32 MaxCursorSamples = 16;
+
+struct cursor_predictor
+{
+    cursor_predictor_config Config;
+
+    cursor_sample Samples[MaxCursorSamples]; // NOTE: Ring buffer, oldest first from NextSample
+    u32 SampleCount;
+    u32 NextSample;
+    r64 LastMoveTime; // NOTE: Time of the latest sample that moved from the one before it
+    r64 MoveInterval; // NOTE: Time between the last two samples that moved, which follows the mouse's report rate
+
+    cursor_kalman_axis KalmanX;
+    cursor_kalman_axis KalmanY;
+};
+
+internal cursor_predictor_config DefaultCursorPredictorConfig()
+{
+    cursor_predictor_config Config;
+    Config.Mode = CursorPrediction_Linear; // NOTE: Overshoots least after a stop (see tests/cursor_replay.cpp)
+    Config.MaxLeadSeconds = 0.05;
+    Config.MaxOvershoot = 48.0;
+    Config.IdleSeconds = 0.1;
+    Config.StopSeconds = 0.012; // NOTE: Longer than the gap between reports from a 125 Hz mouse
+    Config.LinearSampleCount = 4;
+    Config.KalmanAccelerationNoise = 20000.0;
+    Config.KalmanMeasurementNoise = 1.0;
+    return Config;
+}
+
+/// Forgets all of the samples (e.g. when a new drag starts), keeping the configuration.
+internal void ResetCursorPredictor(cursor_predictor *Predictor)
+{
+    Predictor->SampleCount = 0;
+    Predictor->NextSample = 0;
+}
+
+internal const cursor_sample *GetLatestCursorSample(const cursor_predictor *Predictor)
+{
+    return &Predictor->Samples[(Predictor->NextSample + MaxCursorSamples - 1) % MaxCursorSamples];
+}
+
+internal void StartKalmanAxis(cursor_kalman_axis *Axis, r64 Position, r64 MeasurementVariance)
+{
+    Axis->Position = Position;
+    Axis->Velocity = 0.0;
+    Axis->P00 = MeasurementVariance;
+    Axis->P01 = 0.0;
+    Axis->P11 = 1.0e6; // NOTE: Nothing is known about the velocity yet
+}
+
+internal void UpdateKalmanAxis(cursor_kalman_axis *Axis, r64 DeltaTime, r64 Measurement,
+                               r64 AccelerationVariance, r64 MeasurementVariance)
+{
+    // NOTE: Predict (constant velocity, with white-noise acceleration)
+    r64 DeltaTime2 = DeltaTime * DeltaTime;
+    Axis->Position += Axis->Velocity * DeltaTime;
+    r64 P00 = Axis->P00 + DeltaTime * (2.0 * Axis->P01 + DeltaTime * Axis->P11) + AccelerationVariance * DeltaTime2 * DeltaTime2 * 0.25;
+    r64 P01 = Axis->P01 + DeltaTime * Axis->P11 + AccelerationVariance * DeltaTime2 * DeltaTime * 0.5;
+    r64 P11 = Axis->P11 + AccelerationVariance * DeltaTime2;
+
+    // NOTE: Correct with the measured position
+    r64 Innovation = Measurement - Axis->Position;
+    r64 InnovationVariance = P00 + MeasurementVariance;
+    r64 GainPosition = P00 / InnovationVariance;
+    r64 GainVelocity = P01 / InnovationVariance;
+    Axis->Position += GainPosition * Innovation;
+    Axis->Velocity += GainVelocity * Innovation;
+    Axis->P00 = (1.0 - GainPosition) * P00;
+    Axis->P01 = (1.0 - GainPosition) * P01;
+    Axis->P11 = P11 - GainVelocity * P01;
+}
+
+/// Adds a real cursor position, sampled at the given time (in seconds, from any monotonic clock).
+internal void AddCursorSample(cursor_predictor *Predictor, r64 Time, i32 X, i32 Y)
+{
+    const cursor_predictor_config *Config = &Predictor->Config;
+    r64 AccelerationVariance = Config->KalmanAccelerationNoise * Config->KalmanAccelerationNoise;
+    r64 MeasurementVariance = Config->KalmanMeasurementNoise * Config->KalmanMeasurementNoise;
+
+    if (Predictor->SampleCount)
+    {
+        const cursor_sample *Latest = GetLatestCursorSample(Predictor);
+        r64 DeltaTime = Time - Latest->Time;
+        if (DeltaTime <= 0.0 || DeltaTime > Config->IdleSeconds)
+        {
+            // NOTE: The cursor was at rest (or the clock misbehaved), so the old motion no longer applies
+            ResetCursorPredictor(Predictor);
+        }
+        else
+        {
+            UpdateKalmanAxis(&Predictor->KalmanX, DeltaTime, (r64)X, AccelerationVariance, MeasurementVariance);
+            UpdateKalmanAxis(&Predictor->KalmanY, DeltaTime, (r64)Y, AccelerationVariance, MeasurementVariance);
+            if ((r64)X != Latest->X || (r64)Y != Latest->Y)
+            {
+                Predictor->MoveInterval = Time - Predictor->LastMoveTime;
+                Predictor->LastMoveTime = Time;
+            }
+        }
+    }
+
+    if (Predictor->SampleCount == 0)
+    {
+        StartKalmanAxis(&Predictor->KalmanX, (r64)X, MeasurementVariance);
+        StartKalmanAxis(&Predictor->KalmanY, (r64)Y, MeasurementVariance);
+        Predictor->LastMoveTime = Time;
+        Predictor->MoveInterval = Config->StopSeconds;
+    }
+
+    cursor_sample *Sample = &Predictor->Samples[Predictor->NextSample];
+    Sample->Time = Time;
+    Sample->X = (r64)X;
+    Sample->Y = (r64)Y;
+    Predictor->NextSample = (Predictor->NextSample + 1) % MaxCursorSamples;
+    Predictor->SampleCount = Min(Predictor->SampleCount + 1, MaxCursorSamples);
+}
+
+/// Fits a line through the most recent samples, returning its velocity (px/s).
+internal void FitCursorVelocity(const cursor_predictor *Predictor, r64 *VelocityX, r64 *VelocityY)
+{
+    u32 Count = Min(Max(Predictor->Config.LinearSampleCount, 2u), Predictor->SampleCount);
+    const cursor_sample *Latest = GetLatestCursorSample(Predictor);
+
+    // NOTE: Times are taken relative to the latest sample to keep the sums well conditioned
+    r64 SumT = 0.0;
+    r64 SumX = 0.0;
+    r64 SumY = 0.0;
+    r64 SumTT = 0.0;
+    r64 SumTX = 0.0;
+    r64 SumTY = 0.0;
+    for (u32 Age = 0; Age < Count; ++Age)
+    {
+        const cursor_sample *Sample = &Predictor->Samples[(Predictor->NextSample + MaxCursorSamples - 1 - Age) % MaxCursorSamples];
+        r64 T = Sample->Time - Latest->Time;
+        SumT += T;
+        SumX += Sample->X;
+        SumY += Sample->Y;
+        SumTT += T * T;
+        SumTX += T * Sample->X;
+        SumTY += T * Sample->Y;
+    }
+
+    r64 Denominator = (r64)Count * SumTT - SumT * SumT;
+    if (Denominator <= 1.0e-12)
+    {
+        *VelocityX = 0.0;
+        *VelocityY = 0.0;
+    }
+    else
+    {
+        *VelocityX = ((r64)Count * SumTX - SumT * SumX) / Denominator;
+        *VelocityY = ((r64)Count * SumTY - SumT * SumY) / Denominator;
+    }
+}
+
+/// Predicts where the cursor will be at the given time, rounded to the nearest pixel.
+/// Returns false (and the latest sample) if there's nothing to predict from.
+internal b32 PredictCursor(const cursor_predictor *Predictor, r64 Time, i32 *X, i32 *Y)
+{
+    if (Predictor->SampleCount == 0)
+    {
+        return false;
+    }
+
+    const cursor_predictor_config *Config = &Predictor->Config;
+    const cursor_sample *Latest = GetLatestCursorSample(Predictor);
+    *X = (i32)floor(Latest->X + 0.5);
+    *Y = (i32)floor(Latest->Y + 0.5);
+
+    // NOTE: Once the samples stop moving, any lead would only show up as an overshoot
+    r64 LeadTime = Time - Latest->Time;
+    r64 StopSeconds = Min(2.0 * Predictor->MoveInterval, Config->StopSeconds);
+    if (Config->Mode == CursorPrediction_None || Predictor->SampleCount < 2 ||
+        LeadTime > Config->IdleSeconds || Latest->Time - Predictor->LastMoveTime >= StopSeconds)
+    {
+        return true;
+    }
+    LeadTime = Min(Max(LeadTime, 0.0), Config->MaxLeadSeconds);
+
+    r64 PredictedX = Latest->X;
+    r64 PredictedY = Latest->Y;
+    if (Config->Mode == CursorPrediction_Linear)
+    {
+        r64 VelocityX;
+        r64 VelocityY;
+        FitCursorVelocity(Predictor, &VelocityX, &VelocityY);
+        PredictedX += VelocityX * LeadTime;
+        PredictedY += VelocityY * LeadTime;
+    }
+    else
+    {
+        PredictedX = Predictor->KalmanX.Position + Predictor->KalmanX.Velocity * LeadTime;
+        PredictedY = Predictor->KalmanY.Position + Predictor->KalmanY.Velocity * LeadTime;
+    }
+
+    // NOTE: Clamp the overshoot, so sudden stops and direction changes don't fling the corner away
+    r64 LeadX = PredictedX - Latest->X;
+    r64 LeadY = PredictedY - Latest->Y;
+    r64 LeadDistance = sqrt(LeadX * LeadX + LeadY * LeadY);
+    if (LeadDistance > Config->MaxOvershoot)
+    {
+        r64 Scale = Config->MaxOvershoot / LeadDistance;
+        LeadX *= Scale;
+        LeadY *= Scale;
+    }
+
+    *X = (i32)floor(Latest->X + LeadX + 0.5);
+    *Y = (i32)floor(Latest->Y + LeadY + 0.5);
+    return true;
+}
+
+#endif
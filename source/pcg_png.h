@@ -0,0 +1,821 @@
+#if !defined(PCG_PNG_H)
+#define PCG_PNG_H
+/*
+    ==========================================================================
+    File: pcg_png.h
+    Date: 18/10/2026
+    ==========================================================================
+
+    A streaming PNG encoder for 8-bit RGB/RGBA images, used to export the annotated layout.
+
+    Rows are handed over one at a time and buffered until there is one job's worth of rows
+    for every thread. Each job then filters its rows (picking the filter per row with the
+    usual minimum-sum-of-absolute-differences heuristic, vectorized with SSE2 where available),
+    deflates them independently with fixed Huffman codes, and ends on a byte boundary with an
+    empty stored block (a "sync flush"), so the jobs' outputs can simply be concatenated into
+    consecutive IDAT chunks. The Adler-32 checksums of the jobs are combined at the end.
+
+    Memory use is bounded by the job size times the thread count, regardless of image size.
+*/
+
+#include "pcg_cam.h"
+#include <string.h>
+#include <vector>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PCG_PNG_SSE2 1
+#include <emmintrin.h>
+#else
+#define PCG_PNG_SSE2 0
+#endif
+
+/// Called with each piece of the encoded file, in order. Returns false if the data couldn't be written.
+typedef b32 png_write_callback(void *Context, const u8 *Data, u32 Size);
+
+/// The (approximate) amount of filtered image data compressed by a single thread at once.
+const u32 PngJobBytes = 1 << 20;
+
+/// Zero bytes in front of every buffered row, so the filters can read "left of the first pixel".
+const u32 PngRowPadding = 16;
+
+enum png_filter
+{
+    PngFilter_None,
+    PngFilter_Sub,
+    PngFilter_Up,
+    PngFilter_Average,
+    PngFilter_Paeth,
+
+    PngFilter_Count
+};
+
+struct png_job
+{
+    u32 FirstRow;
+    u32 RowCount;
+    b32 IsFirst; // NOTE: The first job of the image also carries the zlib header
+    u32 Adler;
+    u32 FilteredSize;
+    std::vector<u8> Filtered;
+    std::vector<u8> Scratch;
+    std::vector<u8> Chunk; // NOTE: A complete IDAT chunk, ready to be written
+};
+
+struct png_encoder
+{
+    png_write_callback *Write;
+    void *WriteContext;
+
+    u32 Width;
+    u32 Height;
+    u32 BytesPerPixel;
+    u32 RowBytes;
+    u32 RowStride;
+    u32 RowsPerJob;
+    u32 RowsWritten;
+
+    // NOTE: Slot 0 holds the last row of the previous batch (zeros before the first row)
+    std::vector<u8> PendingRows;
+    u32 PendingRowCount;
+
+    std::vector<png_job> Jobs;
+    u32 Adler;
+    b32 Failed;
+};
+
+//
+// NOTE: Checksums
+//
+
+struct png_crc_table
+{
+    u32 Entries[256];
+};
+
+constexpr png_crc_table BuildPngCrcTable()
+{
+    png_crc_table Table = { };
+    for (u32 Index = 0; Index < 256; ++Index)
+    {
+        u32 Crc = Index;
+        for (u32 Bit = 0; Bit < 8; ++Bit)
+        {
+            Crc = (Crc & 1) ? (0xEDB88320u ^ (Crc >> 1)) : (Crc >> 1);
+        }
+        Table.Entries[Index] = Crc;
+    }
+    return Table;
+}
+
+constexpr png_crc_table PngCrcTable = BuildPngCrcTable();
+
+internal u32 UpdatePngCrc(u32 Crc, const u8 *Data, u32 Size)
+{
+    Crc = ~Crc;
+    for (u32 Index = 0; Index < Size; ++Index)
+    {
+        Crc = PngCrcTable.Entries[(Crc ^ Data[Index]) & 0xFF] ^ (Crc >> 8);
+    }
+    return ~Crc;
+}
+
+const u32 AdlerModulus = 65521;
+
+internal u32 UpdateAdler32(u32 Adler, const u8 *Data, u32 Size)
+{
+    u32 A = Adler & 0xFFFF;
+    u32 B = Adler >> 16;
+    while (Size)
+    {
+        // NOTE: 5552 is the most bytes that can be summed before B could overflow
+        u32 BlockSize = Min(Size, 5552u);
+        for (u32 Index = 0; Index < BlockSize; ++Index)
+        {
+            A += Data[Index];
+            B += A;
+        }
+        A %= AdlerModulus;
+        B %= AdlerModulus;
+        Data += BlockSize;
+        Size -= BlockSize;
+    }
+    return (B << 16) | A;
+}
+
+/// Returns the Adler-32 of two buffers joined together, from their separate checksums.
+internal u32 CombineAdler32(u32 AdlerA, u32 AdlerB, u32 SizeB)
+{
+    u32 Remainder = SizeB % AdlerModulus;
+    u32 A = AdlerA & 0xFFFF;
+    u32 B = (u32)(((u64)Remainder * A) % AdlerModulus);
+    A += (AdlerB & 0xFFFF) + AdlerModulus - 1;
+    B += (AdlerA >> 16) + (AdlerB >> 16) + AdlerModulus - Remainder;
+    while (A >= AdlerModulus)
+    {
+        A -= AdlerModulus;
+    }
+    while (B >= AdlerModulus)
+    {
+        B -= AdlerModulus;
+    }
+    return (B << 16) | A;
+}
+
+//
+// NOTE: Filtering
+//
+
+internal u8 PaethPredictor(u8 A, u8 B, u8 C)
+{
+    i32 P = (i32)A + (i32)B - (i32)C;
+    i32 PA = P > A ? P - A : A - P;
+    i32 PB = P > B ? P - B : B - P;
+    i32 PC = P > C ? P - C : C - P;
+    if (PA <= PB && PA <= PC)
+    {
+        return A;
+    }
+    if (PB <= PC)
+    {
+        return B;
+    }
+    return C;
+}
+
+/// The cost of a filtered byte for the filter heuristic (its magnitude as a signed byte).
+internal u32 PngFilterCost(u8 Value)
+{
+    return Value < 128 ? Value : 256 - Value;
+}
+
+/// Filters bytes [Start, End) of a row with every filter, returning the heuristic cost of each.
+/// NOTE: Row and PreviousRow must be preceded by at least BytesPerPixel readable zero bytes
+internal void FilterPngBytesScalar(const u8 *Row, const u8 *PreviousRow, u32 Start, u32 End, u32 BytesPerPixel,
+                                   u8 *Filtered[PngFilter_Count], u64 Cost[PngFilter_Count])
+{
+    const u8 *Left = Row - BytesPerPixel;
+    const u8 *PreviousLeft = PreviousRow - BytesPerPixel;
+    for (u32 Index = Start; Index < End; ++Index)
+    {
+        u8 X = Row[Index];
+        u8 A = Left[Index];
+        u8 B = PreviousRow[Index];
+        u8 C = PreviousLeft[Index];
+
+        u8 Sub = (u8)(X - A);
+        u8 Up = (u8)(X - B);
+        u8 Average = (u8)(X - (u8)(((u32)A + (u32)B) >> 1));
+        u8 Paeth = (u8)(X - PaethPredictor(A, B, C));
+
+        Filtered[PngFilter_Sub][Index] = Sub;
+        Filtered[PngFilter_Up][Index] = Up;
+        Filtered[PngFilter_Average][Index] = Average;
+        Filtered[PngFilter_Paeth][Index] = Paeth;
+
+        Cost[PngFilter_None] += PngFilterCost(X);
+        Cost[PngFilter_Sub] += PngFilterCost(Sub);
+        Cost[PngFilter_Up] += PngFilterCost(Up);
+        Cost[PngFilter_Average] += PngFilterCost(Average);
+        Cost[PngFilter_Paeth] += PngFilterCost(Paeth);
+    }
+}
+
+#if PCG_PNG_SSE2
+internal __m128i PngFilterCostSSE2(__m128i Value)
+{
+    __m128i Zero = _mm_setzero_si128();
+    __m128i Magnitude = _mm_min_epu8(Value, _mm_sub_epi8(Zero, Value));
+    return _mm_sad_epu8(Magnitude, Zero);
+}
+
+internal __m128i Abs16SSE2(__m128i Value)
+{
+    return _mm_max_epi16(Value, _mm_sub_epi16(_mm_setzero_si128(), Value));
+}
+
+/// Paeth predictor for 8 pixels' worth of bytes, widened to 16 bits.
+internal __m128i PaethPredictor16SSE2(__m128i A, __m128i B, __m128i C)
+{
+    __m128i PA = Abs16SSE2(_mm_sub_epi16(B, C));
+    __m128i PB = Abs16SSE2(_mm_sub_epi16(A, C));
+    __m128i PC = Abs16SSE2(_mm_sub_epi16(_mm_add_epi16(A, B), _mm_add_epi16(C, C)));
+
+    // NOTE: UseA = PA <= PB && PA <= PC, UseB = PB <= PC
+    __m128i NotA = _mm_or_si128(_mm_cmpgt_epi16(PA, PB), _mm_cmpgt_epi16(PA, PC));
+    __m128i NotB = _mm_cmpgt_epi16(PB, PC);
+    __m128i BOrC = _mm_or_si128(_mm_andnot_si128(NotB, B), _mm_and_si128(NotB, C));
+    return _mm_or_si128(_mm_andnot_si128(NotA, A), _mm_and_si128(NotA, BOrC));
+}
+
+/// Same as FilterPngBytesScalar, 16 bytes at a time. Returns the first byte it didn't get to.
+internal u32 FilterPngBytesSSE2(const u8 *Row, const u8 *PreviousRow, u32 End, u32 BytesPerPixel,
+                                u8 *Filtered[PngFilter_Count], u64 Cost[PngFilter_Count])
+{
+    __m128i Zero = _mm_setzero_si128();
+    __m128i One = _mm_set1_epi8(1);
+    __m128i CostNone = Zero;
+    __m128i CostSub = Zero;
+    __m128i CostUp = Zero;
+    __m128i CostAverage = Zero;
+    __m128i CostPaeth = Zero;
+
+    u32 Index = 0;
+    for (; Index + 16 <= End; Index += 16)
+    {
+        __m128i X = _mm_loadu_si128((const __m128i *)(Row + Index));
+        __m128i A = _mm_loadu_si128((const __m128i *)(Row - BytesPerPixel + Index));
+        __m128i B = _mm_loadu_si128((const __m128i *)(PreviousRow + Index));
+        __m128i C = _mm_loadu_si128((const __m128i *)(PreviousRow - BytesPerPixel + Index));
+
+        __m128i Sub = _mm_sub_epi8(X, A);
+        __m128i Up = _mm_sub_epi8(X, B);
+
+        // NOTE: _mm_avg_epu8 rounds up, the PNG average rounds down
+        __m128i Floor = _mm_sub_epi8(_mm_avg_epu8(A, B), _mm_and_si128(_mm_xor_si128(A, B), One));
+        __m128i Average = _mm_sub_epi8(X, Floor);
+
+        __m128i PredictorLow = PaethPredictor16SSE2(_mm_unpacklo_epi8(A, Zero), _mm_unpacklo_epi8(B, Zero), _mm_unpacklo_epi8(C, Zero));
+        __m128i PredictorHigh = PaethPredictor16SSE2(_mm_unpackhi_epi8(A, Zero), _mm_unpackhi_epi8(B, Zero), _mm_unpackhi_epi8(C, Zero));
+        __m128i Paeth = _mm_sub_epi8(X, _mm_packus_epi16(PredictorLow, PredictorHigh));
+
+        _mm_storeu_si128((__m128i *)(Filtered[PngFilter_Sub] + Index), Sub);
+        _mm_storeu_si128((__m128i *)(Filtered[PngFilter_Up] + Index), Up);
+        _mm_storeu_si128((__m128i *)(Filtered[PngFilter_Average] + Index), Average);
+        _mm_storeu_si128((__m128i *)(Filtered[PngFilter_Paeth] + Index), Paeth);
+
+        CostNone = _mm_add_epi64(CostNone, PngFilterCostSSE2(X));
+        CostSub = _mm_add_epi64(CostSub, PngFilterCostSSE2(Sub));
+        CostUp = _mm_add_epi64(CostUp, PngFilterCostSSE2(Up));
+        CostAverage = _mm_add_epi64(CostAverage, PngFilterCostSSE2(Average));
+        CostPaeth = _mm_add_epi64(CostPaeth, PngFilterCostSSE2(Paeth));
+    }
+
+    __m128i Costs[PngFilter_Count] = { CostNone, CostSub, CostUp, CostAverage, CostPaeth };
+    for (u32 Filter = 0; Filter < PngFilter_Count; ++Filter)
+    {
+        u64 Lanes[2];
+        _mm_storeu_si128((__m128i *)Lanes, Costs[Filter]);
+        Cost[Filter] += Lanes[0] + Lanes[1];
+    }
+
+    return Index;
+}
+#endif
+
+/// Filters one row into Out (the filter type byte followed by the filtered bytes).
+/// Scratch must hold 4 * RowBytes bytes.
+internal void FilterPngRow(const u8 *Row, const u8 *PreviousRow, u32 RowBytes, u32 BytesPerPixel, u8 *Scratch, u8 *Out)
+{
+    u8 *Filtered[PngFilter_Count] =
+    {
+        (u8 *)Row,
+        Scratch,
+        Scratch + RowBytes,
+        Scratch + 2 * RowBytes,
+        Scratch + 3 * RowBytes,
+    };
+    u64 Cost[PngFilter_Count] = { };
+
+    u32 Index = 0;
+    #if PCG_PNG_SSE2
+    Index = FilterPngBytesSSE2(Row, PreviousRow, RowBytes, BytesPerPixel, Filtered, Cost);
+    #endif
+    FilterPngBytesScalar(Row, PreviousRow, Index, RowBytes, BytesPerPixel, Filtered, Cost);
+
+    u32 BestFilter = PngFilter_None;
+    for (u32 Filter = 1; Filter < PngFilter_Count; ++Filter)
+    {
+        if (Cost[Filter] < Cost[BestFilter])
+        {
+            BestFilter = Filter;
+        }
+    }
+
+    Out[0] = (u8)BestFilter;
+    memcpy(Out + 1, Filtered[BestFilter], RowBytes);
+}
+
+//
+// NOTE: Deflate
+//
+
+struct png_bit_writer
+{
+    std::vector<u8> *Out;
+    u64 Bits;
+    u32 BitCount;
+};
+
+internal void PutBits(png_bit_writer *Writer, u32 Value, u32 Count)
+{
+    Writer->Bits |= (u64)Value << Writer->BitCount;
+    Writer->BitCount += Count;
+    while (Writer->BitCount >= 8)
+    {
+        Writer->Out->push_back((u8)Writer->Bits);
+        Writer->Bits >>= 8;
+        Writer->BitCount -= 8;
+    }
+}
+
+internal void AlignBits(png_bit_writer *Writer)
+{
+    if (Writer->BitCount)
+    {
+        PutBits(Writer, 0, 8 - Writer->BitCount);
+    }
+}
+
+/// The fixed Huffman codes, bit-reversed since deflate writes them most significant bit first.
+struct png_fixed_codes
+{
+    u16 Literal[288];
+    u8 LiteralLength[288];
+    u8 Distance[30];
+};
+
+constexpr u32 ReverseBits(u32 Value, u32 Count)
+{
+    u32 Result = 0;
+    for (u32 Bit = 0; Bit < Count; ++Bit)
+    {
+        Result = (Result << 1) | ((Value >> Bit) & 1);
+    }
+    return Result;
+}
+
+constexpr png_fixed_codes BuildPngFixedCodes()
+{
+    png_fixed_codes Codes = { };
+    for (u32 Symbol = 0; Symbol < 288; ++Symbol)
+    {
+        // NOTE: The fixed code lengths are 8 bits for 0-143, 9 for 144-255, 7 for 256-279 and 8 for 280-287
+        u32 Code = 0xC0 + (Symbol - 280);
+        u32 Length = 8;
+        if (Symbol < 144)
+        {
+            Code = 0x30 + Symbol;
+        }
+        else if (Symbol < 256)
+        {
+            Code = 0x190 + (Symbol - 144);
+            Length = 9;
+        }
+        else if (Symbol < 280)
+        {
+            Code = Symbol - 256;
+            Length = 7;
+        }
+        Codes.Literal[Symbol] = (u16)ReverseBits(Code, Length);
+        Codes.LiteralLength[Symbol] = (u8)Length;
+    }
+    for (u32 Symbol = 0; Symbol < 30; ++Symbol)
+    {
+        Codes.Distance[Symbol] = (u8)ReverseBits(Symbol, 5);
+    }
+    return Codes;
+}
+
+constexpr png_fixed_codes PngFixedCodes = BuildPngFixedCodes();
+
+internal u32 HighestBit(u32 Value)
+{
+    u32 Bit = 0;
+    while (Value >>= 1)
+    {
+        ++Bit;
+    }
+    return Bit;
+}
+
+internal void PutLiteral(png_bit_writer *Writer, u32 Symbol)
+{
+    PutBits(Writer, PngFixedCodes.Literal[Symbol], PngFixedCodes.LiteralLength[Symbol]);
+}
+
+internal void PutMatch(png_bit_writer *Writer, u32 Length, u32 Distance)
+{
+    // NOTE: Length codes 257-284 cover 3-257 in groups of four per extra bit, 258 has its own code
+    u32 LengthValue = Length - 3;
+    if (Length == 258)
+    {
+        PutLiteral(Writer, 285);
+    }
+    else if (LengthValue < 8)
+    {
+        PutLiteral(Writer, 257 + LengthValue);
+    }
+    else
+    {
+        u32 Top = HighestBit(LengthValue);
+        u32 ExtraBits = Top - 2;
+        PutLiteral(Writer, 257 + 4 * (Top - 1) + ((LengthValue >> ExtraBits) & 3));
+        PutBits(Writer, LengthValue & ((1u << ExtraBits) - 1), ExtraBits);
+    }
+
+    // NOTE: Distance codes come in pairs per extra bit
+    u32 DistanceValue = Distance - 1;
+    if (DistanceValue < 4)
+    {
+        PutBits(Writer, PngFixedCodes.Distance[DistanceValue], 5);
+    }
+    else
+    {
+        u32 Top = HighestBit(DistanceValue);
+        u32 ExtraBits = Top - 1;
+        PutBits(Writer, PngFixedCodes.Distance[2 * Top + ((DistanceValue >> ExtraBits) & 1)], 5);
+        PutBits(Writer, DistanceValue & ((1u << ExtraBits) - 1), ExtraBits);
+    }
+}
+
+const u32 DeflateWindowSize = 32768;
+const u32 DeflateHashBits = 15;
+const u32 DeflateMaxChain = 8;
+const u32 DeflateMinMatch = 3;
+const u32 DeflateMaxMatch = 258;
+
+internal u32 DeflateHash(const u8 *Data)
+{
+    u32 Value = (u32)Data[0] | ((u32)Data[1] << 8) | ((u32)Data[2] << 16);
+    return (Value * 2654435761u) >> (32 - DeflateHashBits);
+}
+
+/// Writes stored (uncompressed) blocks, for data that the fixed codes would only make bigger.
+internal void DeflateStored(png_bit_writer *Writer, const u8 *Data, u32 Size)
+{
+    do
+    {
+        u32 BlockSize = Min(Size, 65535u);
+        PutBits(Writer, 0, 3); // NOTE: Not final, stored
+        AlignBits(Writer);
+        PutBits(Writer, BlockSize, 16);
+        PutBits(Writer, ~BlockSize & 0xFFFF, 16);
+        Writer->Out->insert(Writer->Out->end(), Data, Data + BlockSize);
+        Data += BlockSize;
+        Size -= BlockSize;
+    }
+    while (Size);
+}
+
+/// Compresses a self-contained piece of a deflate stream (no back-references outside of it),
+/// ending on a byte boundary so the next piece can be appended directly.
+internal void DeflatePiece(const u8 *Data, u32 Size, std::vector<u8> *Out)
+{
+    size_t OutStart = Out->size();
+    png_bit_writer Writer = { Out, 0, 0 };
+
+    std::vector<i32> Head((size_t)1 << DeflateHashBits, -1);
+    std::vector<i32> Previous(DeflateWindowSize, -1);
+
+    PutBits(&Writer, 2, 3); // NOTE: Not final, fixed Huffman codes
+
+    u32 Position = 0;
+    while (Position + DeflateMinMatch <= Size)
+    {
+        u32 Hash = DeflateHash(Data + Position);
+        i32 Candidate = Head[Hash];
+        Previous[Position & (DeflateWindowSize - 1)] = Candidate;
+        Head[Hash] = (i32)Position;
+
+        u32 MaxLength = Min(DeflateMaxMatch, Size - Position);
+        u32 BestLength = 0;
+        u32 BestDistance = 0;
+        for (u32 Chain = 0; Chain < DeflateMaxChain && Candidate >= 0; ++Chain)
+        {
+            u32 Distance = Position - (u32)Candidate;
+            if (Distance > DeflateWindowSize)
+            {
+                break;
+            }
+
+            const u8 *Match = Data + Candidate;
+            if (Match[BestLength] == Data[Position + BestLength])
+            {
+                u32 Length = 0;
+                while (Length < MaxLength && Match[Length] == Data[Position + Length])
+                {
+                    ++Length;
+                }
+                if (Length > BestLength)
+                {
+                    BestLength = Length;
+                    BestDistance = Distance;
+                    if (Length == MaxLength)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            // NOTE: The window slot may have been reused by a newer position, which ends the chain
+            i32 Next = Previous[(u32)Candidate & (DeflateWindowSize - 1)];
+            if (Next >= Candidate)
+            {
+                break;
+            }
+            Candidate = Next;
+        }
+
+        if (BestLength >= DeflateMinMatch)
+        {
+            PutMatch(&Writer, BestLength, BestDistance);
+
+            // NOTE: Keep the hash chains up to date for the positions covered by the match
+            u32 MatchEnd = Position + BestLength;
+            for (++Position; Position < MatchEnd && Position + DeflateMinMatch <= Size; ++Position)
+            {
+                u32 SkippedHash = DeflateHash(Data + Position);
+                Previous[Position & (DeflateWindowSize - 1)] = Head[SkippedHash];
+                Head[SkippedHash] = (i32)Position;
+            }
+            Position = MatchEnd;
+        }
+        else
+        {
+            PutLiteral(&Writer, Data[Position]);
+            ++Position;
+        }
+    }
+
+    while (Position < Size)
+    {
+        PutLiteral(&Writer, Data[Position]);
+        ++Position;
+    }
+
+    PutLiteral(&Writer, 256); // NOTE: End of block
+
+    // NOTE: Sync flush (an empty stored block), which also byte-aligns the output
+    PutBits(&Writer, 0, 3);
+    AlignBits(&Writer);
+    PutBits(&Writer, 0x0000, 16);
+    PutBits(&Writer, 0xFFFF, 16);
+
+    // NOTE: Fall back to stored blocks if compression didn't pay off
+    size_t StoredSize = (size_t)Size + 5 * ((size_t)Size / 65535 + 1) + 5;
+    if (Out->size() - OutStart > StoredSize)
+    {
+        Out->resize(OutStart);
+        Writer.Bits = 0;
+        Writer.BitCount = 0;
+        DeflateStored(&Writer, Data, Size);
+    }
+}
+
+//
+// NOTE: Encoder
+//
+
+internal void PutU32BigEndian(u8 *Out, u32 Value)
+{
+    Out[0] = (u8)(Value >> 24);
+    Out[1] = (u8)(Value >> 16);
+    Out[2] = (u8)(Value >> 8);
+    Out[3] = (u8)Value;
+}
+
+/// Fills in the length and CRC of a chunk whose type and data follow an 8-byte placeholder at Start.
+internal void FinishPngChunk(std::vector<u8> *Chunk, size_t Start, const char *Type)
+{
+    u32 DataSize = (u32)(Chunk->size() - Start - 8);
+    PutU32BigEndian(Chunk->data() + Start, DataSize);
+    memcpy(Chunk->data() + Start + 4, Type, 4);
+
+    u8 Crc[4];
+    PutU32BigEndian(Crc, UpdatePngCrc(0, Chunk->data() + Start + 4, DataSize + 4));
+    Chunk->insert(Chunk->end(), Crc, Crc + 4);
+}
+
+internal b32 WritePngChunk(png_encoder *Encoder, const char *Type, const u8 *Data, u32 Size)
+{
+    std::vector<u8> Chunk(8);
+    Chunk.insert(Chunk.end(), Data, Data + Size);
+    FinishPngChunk(&Chunk, 0, Type);
+
+    if (!Encoder->Failed && !Encoder->Write(Encoder->WriteContext, Chunk.data(), (u32)Chunk.size()))
+    {
+        Encoder->Failed = true;
+    }
+    return !Encoder->Failed;
+}
+
+internal u8 *GetPendingRow(png_encoder *Encoder, u32 Slot)
+{
+    return Encoder->PendingRows.data() + (size_t)Slot * Encoder->RowStride + PngRowPadding;
+}
+
+/// Filters and compresses one job's rows into a finished IDAT chunk (runs on a worker thread).
+internal void EncodePngJob(png_encoder *Encoder, png_job *Job)
+{
+    u32 RowBytes = Encoder->RowBytes;
+    Job->FilteredSize = Job->RowCount * (RowBytes + 1);
+    Job->Filtered.resize(Job->FilteredSize);
+    Job->Scratch.resize(4 * (size_t)RowBytes);
+
+    for (u32 Row = 0; Row < Job->RowCount; ++Row)
+    {
+        u32 Slot = 1 + Job->FirstRow + Row;
+        FilterPngRow(GetPendingRow(Encoder, Slot), GetPendingRow(Encoder, Slot - 1),
+                     RowBytes, Encoder->BytesPerPixel, Job->Scratch.data(),
+                     Job->Filtered.data() + (size_t)Row * (RowBytes + 1));
+    }
+
+    Job->Adler = UpdateAdler32(1, Job->Filtered.data(), Job->FilteredSize);
+
+    Job->Chunk.assign(8, 0);
+    if (Job->IsFirst)
+    {
+        // NOTE: zlib header (deflate, 32K window, no dictionary)
+        Job->Chunk.push_back(0x78);
+        Job->Chunk.push_back(0x01);
+    }
+    DeflatePiece(Job->Filtered.data(), Job->FilteredSize, &Job->Chunk);
+    FinishPngChunk(&Job->Chunk, 0, "IDAT");
+}
+
+/// Encodes every buffered row (in parallel) and writes the resulting IDAT chunks in order.
+internal b32 FlushPngRows(png_encoder *Encoder)
+{
+    if (Encoder->PendingRowCount == 0)
+    {
+        return !Encoder->Failed;
+    }
+
+    u32 JobCount = 0;
+    for (u32 FirstRow = 0; FirstRow < Encoder->PendingRowCount; FirstRow += Encoder->RowsPerJob)
+    {
+        png_job *Job = &Encoder->Jobs[JobCount++];
+        Job->FirstRow = FirstRow;
+        Job->RowCount = Min(Encoder->RowsPerJob, Encoder->PendingRowCount - FirstRow);
+        Job->IsFirst = (Encoder->RowsWritten - Encoder->PendingRowCount + FirstRow) == 0;
+    }
+
+    std::vector<std::thread> Workers;
+    for (u32 JobIndex = 1; JobIndex < JobCount; ++JobIndex)
+    {
+        Workers.emplace_back(EncodePngJob, Encoder, &Encoder->Jobs[JobIndex]);
+    }
+    EncodePngJob(Encoder, &Encoder->Jobs[0]);
+    for (std::thread &Worker : Workers)
+    {
+        Worker.join();
+    }
+
+    for (u32 JobIndex = 0; JobIndex < JobCount; ++JobIndex)
+    {
+        png_job *Job = &Encoder->Jobs[JobIndex];
+        Encoder->Adler = CombineAdler32(Encoder->Adler, Job->Adler, Job->FilteredSize);
+        if (!Encoder->Failed && !Encoder->Write(Encoder->WriteContext, Job->Chunk.data(), (u32)Job->Chunk.size()))
+        {
+            Encoder->Failed = true;
+        }
+    }
+
+    // NOTE: The next batch is filtered against the last row of this one
+    memcpy(GetPendingRow(Encoder, 0), GetPendingRow(Encoder, Encoder->PendingRowCount), Encoder->RowBytes);
+    Encoder->PendingRowCount = 0;
+
+    return !Encoder->Failed;
+}
+
+/// Starts encoding an image, and writes the PNG signature and header.
+/// BytesPerPixel is 3 for RGB or 4 for RGBA. A ThreadCount of 0 uses every hardware thread.
+internal b32 BeginPngEncode(png_encoder *Encoder, u32 Width, u32 Height, u32 BytesPerPixel,
+                            png_write_callback *Write, void *WriteContext, u32 ThreadCount)
+{
+    if (Width == 0 || Height == 0 || Width > 0x7FFFFFFF / 4 || (BytesPerPixel != 3 && BytesPerPixel != 4))
+    {
+        return false;
+    }
+
+    if (ThreadCount == 0)
+    {
+        ThreadCount = Max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    Encoder->Write = Write;
+    Encoder->WriteContext = WriteContext;
+    Encoder->Width = Width;
+    Encoder->Height = Height;
+    Encoder->BytesPerPixel = BytesPerPixel;
+    Encoder->RowBytes = Width * BytesPerPixel;
+    Encoder->RowStride = PngRowPadding + Encoder->RowBytes;
+    Encoder->RowsPerJob = Max(PngJobBytes / (Encoder->RowBytes + 1), 1u);
+    Encoder->RowsWritten = 0;
+    Encoder->PendingRowCount = 0;
+    Encoder->PendingRows.assign((1 + (size_t)ThreadCount * Encoder->RowsPerJob) * Encoder->RowStride, 0);
+    Encoder->Jobs.resize(ThreadCount);
+    Encoder->Adler = 1;
+    Encoder->Failed = false;
+
+    const u8 Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (!Write(WriteContext, Signature, sizeof(Signature)))
+    {
+        Encoder->Failed = true;
+        return false;
+    }
+
+    u8 Header[13];
+    PutU32BigEndian(Header, Width);
+    PutU32BigEndian(Header + 4, Height);
+    Header[8] = 8;                           // NOTE: Bit depth
+    Header[9] = (u8)(BytesPerPixel == 4 ? 6 : 2); // NOTE: Colour type (RGBA or RGB)
+    Header[10] = 0;                          // NOTE: Compression method
+    Header[11] = 0;                          // NOTE: Filter method
+    Header[12] = 0;                          // NOTE: No interlacing
+    return WritePngChunk(Encoder, "IHDR", Header, sizeof(Header));
+}
+
+/// Adds the next row of the image (top to bottom).
+internal b32 WritePngRow(png_encoder *Encoder, const u8 *Row)
+{
+    if (Encoder->Failed || Encoder->RowsWritten >= Encoder->Height)
+    {
+        return false;
+    }
+
+    memcpy(GetPendingRow(Encoder, 1 + Encoder->PendingRowCount), Row, Encoder->RowBytes);
+    ++Encoder->PendingRowCount;
+    ++Encoder->RowsWritten;
+
+    if (Encoder->PendingRowCount == Encoder->Jobs.size() * Encoder->RowsPerJob)
+    {
+        return FlushPngRows(Encoder);
+    }
+    return true;
+}
+
+/// Finishes the image once every row has been written, and frees the encoder's buffers.
+internal b32 EndPngEncode(png_encoder *Encoder)
+{
+    b32 Result = !Encoder->Failed && Encoder->RowsWritten == Encoder->Height;
+
+    if (Result && FlushPngRows(Encoder))
+    {
+        // NOTE: An empty final block, followed by the zlib checksum
+        std::vector<u8> Tail;
+        png_bit_writer Writer = { &Tail, 0, 0 };
+        PutBits(&Writer, 3, 3); // NOTE: Final, fixed Huffman codes
+        PutLiteral(&Writer, 256);
+        AlignBits(&Writer);
+
+        u8 Adler[4];
+        PutU32BigEndian(Adler, Encoder->Adler);
+        Tail.insert(Tail.end(), Adler, Adler + 4);
+
+        Result = WritePngChunk(Encoder, "IDAT", Tail.data(), (u32)Tail.size()) &&
+                 WritePngChunk(Encoder, "IEND", 0, 0);
+    }
+    else
+    {
+        Result = false;
+    }
+
+    Encoder->PendingRows = std::vector<u8>();
+    Encoder->Jobs = std::vector<png_job>();
+
+    return Result;
+}
+
+#endif
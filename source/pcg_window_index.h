@@ -0,0 +1,278 @@
+#if !defined(PCG_WINDOW_INDEX_H)
+#define PCG_WINDOW_INDEX_H
+/*
+    ==========================================================================
+    File: pcg_window_index.h
+    Date: 18/10/2026
+    ==========================================================================
+
+    A snapshot of the top-level windows (bounds and z-order) and a spatial index over it,
+    used by the window picker to find the front-most window under the cursor.
+
+    The index cuts the screen into vertical slabs at every window's left/right edge, and each
+    slab into horizontal spans at every top/bottom edge. Each span stores the front-most window
+    covering it, so a hit-test is two binary searches. Adjacent slabs with identical spans are
+    merged to keep the tables small.
+*/
+
+#include "pcg_cam.h"
+#include <vector>
+#include <algorithm>
+
+/// A top-level window's bounds in screen coordinates (Right and Bottom are exclusive).
+struct window_entry
+{
+    u64 Id;
+    i32 Left;
+    i32 Top;
+    i32 Right;
+    i32 Bottom;
+};
+
+/// The pickable windows, ordered front-to-back (index 0 is the top of the z-order).
+struct window_snapshot
+{
+    std::vector<window_entry> Entries;
+    b32 IsDirty; // NOTE: Set whenever Entries changes, cleared once the index has been rebuilt
+};
+
+struct window_index
+{
+    std::vector<i32> SlabX;         // NOTE: Left edge of each slab, plus the right edge of the last slab
+    std::vector<u32> SlabFirstSpan; // NOTE: First span of each slab, plus one past the last span
+    std::vector<i32> SpanY;         // NOTE: Top edge of each span (a span ends where the next one starts)
+    std::vector<i32> SpanWindow;    // NOTE: Snapshot entry covering the span, or -1 for none
+};
+
+internal b32 IsWindowEntryEmpty(const window_entry *Entry)
+{
+    return Entry->Right <= Entry->Left || Entry->Bottom <= Entry->Top;
+}
+
+/// Returns the position of the window with the given ID in the snapshot, or -1 if it isn't in there.
+internal i32 FindSnapshotWindow(const window_snapshot *Snapshot, u64 Id)
+{
+    for (u32 EntryIndex = 0; EntryIndex < Snapshot->Entries.size(); ++EntryIndex)
+    {
+        if (Snapshot->Entries[EntryIndex].Id == Id)
+        {
+            return (i32)EntryIndex;
+        }
+    }
+
+    return -1;
+}
+
+internal void RemoveSnapshotWindow(window_snapshot *Snapshot, u64 Id)
+{
+    i32 EntryIndex = FindSnapshotWindow(Snapshot, Id);
+    if (EntryIndex >= 0)
+    {
+        Snapshot->Entries.erase(Snapshot->Entries.begin() + EntryIndex);
+        Snapshot->IsDirty = true;
+    }
+}
+
+/// Updates the bounds of a window (adding it if it's new), and places it directly behind the window with
+/// the given ID. An AboveId of 0 (or one that isn't in the snapshot) places it at the front.
+/// NOTE: The caller looks up AboveId from the real z-order, since a window can be shown, moved or
+/// activated without ending up on top (e.g. behind a topmost window)
+internal void UpdateSnapshotWindow(window_snapshot *Snapshot, window_entry Entry, u64 AboveId)
+{
+    if (IsWindowEntryEmpty(&Entry))
+    {
+        RemoveSnapshotWindow(Snapshot, Entry.Id);
+        return;
+    }
+
+    i32 EntryIndex = FindSnapshotWindow(Snapshot, Entry.Id);
+    i32 AboveIndex = AboveId ? FindSnapshotWindow(Snapshot, AboveId) : -1;
+    if (EntryIndex < 0)
+    {
+        Snapshot->Entries.insert(Snapshot->Entries.begin() + (AboveIndex + 1), Entry);
+        Snapshot->IsDirty = true;
+        return;
+    }
+
+    window_entry *Existing = &Snapshot->Entries[EntryIndex];
+    if (Existing->Left != Entry.Left || Existing->Top != Entry.Top ||
+        Existing->Right != Entry.Right || Existing->Bottom != Entry.Bottom)
+    {
+        *Existing = Entry;
+        Snapshot->IsDirty = true;
+    }
+
+    // NOTE: Move the window into place, shifting the windows in between by one
+    if (AboveIndex + 1 < EntryIndex)
+    {
+        std::rotate(Snapshot->Entries.begin() + (AboveIndex + 1), Snapshot->Entries.begin() + EntryIndex, Snapshot->Entries.begin() + EntryIndex + 1);
+        Snapshot->IsDirty = true;
+    }
+    else if (AboveIndex > EntryIndex)
+    {
+        std::rotate(Snapshot->Entries.begin() + EntryIndex, Snapshot->Entries.begin() + EntryIndex + 1, Snapshot->Entries.begin() + AboveIndex + 1);
+        Snapshot->IsDirty = true;
+    }
+}
+
+/// Returns the first span at or after the given one that hasn't been claimed by a window yet.
+internal u32 FindUnclaimedSpan(std::vector<u32> &NextUnclaimed, u32 Span)
+{
+    u32 Root = Span;
+    while (NextUnclaimed[Root] != Root)
+    {
+        Root = NextUnclaimed[Root];
+    }
+
+    // NOTE: Path compression, so runs of claimed spans are only walked once
+    while (NextUnclaimed[Span] != Root)
+    {
+        u32 Next = NextUnclaimed[Span];
+        NextUnclaimed[Span] = Root;
+        Span = Next;
+    }
+
+    return Root;
+}
+
+/// Rebuilds the index from a front-to-back list of windows.
+internal void BuildWindowIndex(window_index *Index, const window_entry *Entries, u32 EntryCount)
+{
+    Index->SlabX.clear();
+    Index->SlabFirstSpan.clear();
+    Index->SpanY.clear();
+    Index->SpanWindow.clear();
+
+    std::vector<i32> EdgesX;
+    std::vector<i32> EdgesY;
+    for (u32 EntryIndex = 0; EntryIndex < EntryCount; ++EntryIndex)
+    {
+        const window_entry *Entry = &Entries[EntryIndex];
+        if (!IsWindowEntryEmpty(Entry))
+        {
+            EdgesX.push_back(Entry->Left);
+            EdgesX.push_back(Entry->Right);
+            EdgesY.push_back(Entry->Top);
+            EdgesY.push_back(Entry->Bottom);
+        }
+    }
+
+    if (EdgesX.empty())
+    {
+        Index->SlabFirstSpan.push_back(0);
+        return;
+    }
+
+    std::sort(EdgesX.begin(), EdgesX.end());
+    EdgesX.erase(std::unique(EdgesX.begin(), EdgesX.end()), EdgesX.end());
+    std::sort(EdgesY.begin(), EdgesY.end());
+    EdgesY.erase(std::unique(EdgesY.begin(), EdgesY.end()), EdgesY.end());
+
+    // NOTE: The rows each window covers, as indices into EdgesY
+    std::vector<u32> FirstRow(EntryCount);
+    std::vector<u32> EndRow(EntryCount);
+    for (u32 EntryIndex = 0; EntryIndex < EntryCount; ++EntryIndex)
+    {
+        const window_entry *Entry = &Entries[EntryIndex];
+        if (!IsWindowEntryEmpty(Entry))
+        {
+            FirstRow[EntryIndex] = (u32)(std::lower_bound(EdgesY.begin(), EdgesY.end(), Entry->Top) - EdgesY.begin());
+            EndRow[EntryIndex] = (u32)(std::lower_bound(EdgesY.begin(), EdgesY.end(), Entry->Bottom) - EdgesY.begin());
+        }
+    }
+
+    u32 RowCount = (u32)EdgesY.size() - 1;
+    std::vector<i32> RowWindow(RowCount);
+    std::vector<u32> NextUnclaimed(RowCount + 1);
+
+    for (u32 Slab = 0; Slab + 1 < EdgesX.size(); ++Slab)
+    {
+        i32 SlabLeft = EdgesX[Slab];
+
+        // NOTE: Paint the windows covering this slab front-to-back; each row keeps the first window to claim it
+        for (u32 Row = 0; Row <= RowCount; ++Row)
+        {
+            NextUnclaimed[Row] = Row;
+        }
+        std::fill(RowWindow.begin(), RowWindow.end(), -1);
+
+        for (u32 EntryIndex = 0; EntryIndex < EntryCount; ++EntryIndex)
+        {
+            const window_entry *Entry = &Entries[EntryIndex];
+            if (IsWindowEntryEmpty(Entry) || Entry->Left > SlabLeft || Entry->Right <= SlabLeft)
+            {
+                continue;
+            }
+
+            for (u32 Row = FindUnclaimedSpan(NextUnclaimed, FirstRow[EntryIndex]);
+                 Row < EndRow[EntryIndex];
+                 Row = FindUnclaimedSpan(NextUnclaimed, Row))
+            {
+                RowWindow[Row] = (i32)EntryIndex;
+                NextUnclaimed[Row] = Row + 1;
+            }
+        }
+
+        // NOTE: Collapse rows into spans, dropping the uncovered rows above the first window
+        u32 FirstSpan = (u32)Index->SpanY.size();
+        i32 PreviousWindow = -1;
+        for (u32 Row = 0; Row < RowCount; ++Row)
+        {
+            if (RowWindow[Row] != PreviousWindow)
+            {
+                Index->SpanY.push_back(EdgesY[Row]);
+                Index->SpanWindow.push_back(RowWindow[Row]);
+                PreviousWindow = RowWindow[Row];
+            }
+        }
+        if (PreviousWindow != -1)
+        {
+            Index->SpanY.push_back(EdgesY[RowCount]);
+            Index->SpanWindow.push_back(-1);
+        }
+
+        // NOTE: Merge this slab into the previous one if they have the same spans
+        if (!Index->SlabX.empty())
+        {
+            u32 PreviousFirstSpan = Index->SlabFirstSpan.back();
+            u32 SpanCount = (u32)Index->SpanY.size() - FirstSpan;
+            if (FirstSpan - PreviousFirstSpan == SpanCount &&
+                std::equal(Index->SpanY.begin() + FirstSpan, Index->SpanY.end(), Index->SpanY.begin() + PreviousFirstSpan) &&
+                std::equal(Index->SpanWindow.begin() + FirstSpan, Index->SpanWindow.end(), Index->SpanWindow.begin() + PreviousFirstSpan))
+            {
+                Index->SpanY.resize(FirstSpan);
+                Index->SpanWindow.resize(FirstSpan);
+                continue;
+            }
+        }
+
+        Index->SlabX.push_back(SlabLeft);
+        Index->SlabFirstSpan.push_back(FirstSpan);
+    }
+
+    Index->SlabX.push_back(EdgesX.back());
+    Index->SlabFirstSpan.push_back((u32)Index->SpanY.size());
+}
+
+/// Returns the snapshot entry of the front-most window containing the given point, or -1 if there isn't one.
+internal i32 WindowIndexHitTest(const window_index *Index, i32 X, i32 Y)
+{
+    if (Index->SlabX.size() < 2 || X < Index->SlabX.front() || X >= Index->SlabX.back())
+    {
+        return -1;
+    }
+
+    u32 Slab = (u32)(std::upper_bound(Index->SlabX.begin(), Index->SlabX.end(), X) - Index->SlabX.begin()) - 1;
+
+    std::vector<i32>::const_iterator FirstSpan = Index->SpanY.begin() + Index->SlabFirstSpan[Slab];
+    std::vector<i32>::const_iterator EndSpan = Index->SpanY.begin() + Index->SlabFirstSpan[Slab + 1];
+    std::vector<i32>::const_iterator Span = std::upper_bound(FirstSpan, EndSpan, Y);
+    if (Span == FirstSpan)
+    {
+        return -1;
+    }
+
+    return Index->SpanWindow[(Span - Index->SpanY.begin()) - 1];
+}
+
+#endif
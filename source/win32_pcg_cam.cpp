@@ -3,7 +3,7 @@
     File: win32_pcg_cam.cpp
     Date: 02/05/2022
     Creator: Logix
-    Version: 1.2
+    Version: 1.3
     ==========================================================================
 
     This is a simple utility program to select a region of the screen with your cursor
@@ -23,6 +23,15 @@
         - Updated drawing routines to position the information within the selection rectangle when it
             gets too close to the screen edges
         - The refresh rate will now update on a per-screen basis
+    v1.3:
+        - Added a window picker (toggled with [W]) to select the bounds of an existing window with a single click
+        - The program is now DPI aware, so the offsets are in physical pixels on scaled displays (the text,
+            labels and minimum selection size are scaled to match)
+        - Replaced the PCG_INTERNAL / PCG_ATTEMPT_VSYNC #if blocks with compile-time policies, and added a
+            build target (build -variants) that compiles every combination and benchmarks their painting
+        - The finished selection can be exported as a full-resolution annotated PNG
+        - The selection corner is predicted ahead to when the frame is shown while dragging (-predict:none to disable)
+        - Offsets can be reported on an OBS canvas of a different size to the monitor (-canvas:1920x1080)
 
     TODO
       - [✓] Prevent flickering
@@ -39,18 +48,43 @@
 #include <Windows.h>
 #include <windowsx.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
 #include <gdiplus.h>
 #include <uxtheme.h>
+#include <dwmapi.h>
 
-#define globalvar static
-#define internal static
-#define localpersist static
+#include "pcg_cam.h"
+#include "pcg_window_index.h"
+#include "pcg_png.h"
+#include "pcg_cursor_predictor.h"
+#include "pcg_canvas_map.h"
+#include "win32_pcg_policies.h"
 
-typedef uint32_t  u32;
-typedef int32_t   i32;
-typedef uint32_t  b32;
-typedef float     r32;
+#if !defined(PCG_INTERNAL)
+#define PCG_INTERNAL 0
+#endif
+#if !defined(PCG_ATTEMPT_VSYNC)
+#define PCG_ATTEMPT_VSYNC 1
+#endif
+#if !defined(PCG_BUFFERED_PAINT)
+#define PCG_BUFFERED_PAINT 1
+#endif
+#if !defined(PCG_DEBUG_OVERLAY)
+#define PCG_DEBUG_OVERLAY 0
+#endif
+#if !defined(PCG_BENCHMARK)
+#define PCG_BENCHMARK 0
+#endif
+
+#if PCG_BENCHMARK
+#include <stdio.h>
+#include <utility>
+#endif
+
+/// The variant this build runs with.
+typedef pcg_variant_from_flags<PCG_INTERNAL, PCG_ATTEMPT_VSYNC, PCG_BUFFERED_PAINT, PCG_DEBUG_OVERLAY> pcg_build_variant;
 
 struct rect2i
 {
@@ -67,22 +101,54 @@ struct pcg_cam_result
     i32 Bottom;
 };
 
-#define Min(A, B) ((A) < (B) ? (A) : (B))
-#define Max(A, B) ((A) > (B) ? (A) : (B))
-
-/// The minimum size for a selection box (not currently DPI-friendly).
+/// The minimum size for a selection box at 96 DPI (see GetMinSelectionSize).
 const i32 MinSize = 32;
 
+/// The timer that brings the window index up to date while picking a window, and how often it fires.
+const UINT_PTR WindowIndexTimerId = 998;
+const UINT WindowIndexTimerMs = 33;
+
 globalvar WINDOWPLACEMENT G_WindowPosition = { sizeof(G_WindowPosition) };
 globalvar b32 G_Running;
 globalvar b32 G_HasDrawnSelection;
 globalvar b32 G_IsDrawingSelection;
 globalvar POINT G_SelectionStart;
 globalvar POINT G_SelectionEnd;
+globalvar POINT G_DisplayEnd; // NOTE: Where the selection end is drawn while dragging (may be predicted); never reported
 globalvar b32 G_SelectionIsValid;
 globalvar HMONITOR G_WindowMonitor;
 globalvar r32 G_WorkAreaW;
 globalvar r32 G_WorkAreaH;
+globalvar HWND G_OverlayWindow;
+globalvar b32 G_IsPickingWindow;
+globalvar i32 G_HoveredWindow = -1;
+globalvar window_snapshot G_WindowSnapshot;
+globalvar window_index G_WindowIndex;
+globalvar std::vector<window_entry> G_IndexedWindows; // NOTE: The entries G_WindowIndex was built from (the snapshot moves on between rebuilds)
+globalvar b32 G_WindowOrderIsStale; // NOTE: The z-order changed in a way the window events don't describe
+globalvar HWINEVENTHOOK G_WindowEventHook;
+globalvar b32 G_IsExporting;
+globalvar i32 G_MonitorRefreshHz = 60;
+globalvar r64 G_PerformanceFrequency;
+globalvar cursor_predictor G_CursorPredictor;
+globalvar i32 G_CanvasW; // NOTE: The OBS canvas size (-canvas:WxH), or 0 to report monitor pixels
+globalvar i32 G_CanvasH;
+globalvar canvas_map G_CanvasMap;
+globalvar r32 G_DpiScale = 1.0f; // NOTE: The DPI of the overlay's monitor over 96, which the text and labels are sized for
+
+/// Returns the time in seconds, from the performance counter.
+internal r64 GetSeconds()
+{
+    LARGE_INTEGER Counter;
+    QueryPerformanceCounter(&Counter);
+    return (r64)Counter.QuadPart / G_PerformanceFrequency;
+}
+
+/// Returns the minimum size for a selection box on the overlay's monitor, in physical pixels.
+internal i32 GetMinSelectionSize()
+{
+    return (i32)((r32)MinSize * G_DpiScale + 0.5f);
+}
 
 /// Returns whether the two given points have different X -or- Y coordinates.
 internal b32 ArePointsDifferent(POINT A, POINT B)
@@ -90,6 +156,13 @@ internal b32 ArePointsDifferent(POINT A, POINT B)
     return A.x != B.x || A.y != B.y;
 }
 
+/// Returns whether there is a selection on screen (one being drawn, the hovered window in picker mode,
+/// or the final selection while it is being exported).
+internal b32 IsSelectionVisible()
+{
+    return G_IsDrawingSelection || (G_IsPickingWindow && G_HoveredWindow >= 0) || G_IsExporting;
+}
+
 /// Makes the given window cover the entire screen (including the TaskBar).
 internal void ToggleWindowFullScreen(HWND Window)
 {
@@ -112,32 +185,42 @@ internal void ToggleWindowFullScreen(HWND Window)
     }
 }
 
-/// Converts the current selection into a RECT structure.
+/// Returns where the selection end should be drawn: the predicted cursor position while dragging, the real
+/// selection end otherwise.
+internal POINT GetDisplayedSelectionEnd()
+{
+    return G_IsDrawingSelection ? G_DisplayEnd : G_SelectionEnd;
+}
+
+/// Converts the displayed selection into a RECT structure.
 internal RECT GetSelectionRect()
 {
+    POINT SelectionEnd = GetDisplayedSelectionEnd();
     RECT SelectionRect;
 
     SelectionRect.left = G_SelectionStart.x;
     SelectionRect.top = G_SelectionStart.y;
-    SelectionRect.right = G_SelectionEnd.x;
-    SelectionRect.bottom = G_SelectionEnd.y;
+    SelectionRect.right = SelectionEnd.x;
+    SelectionRect.bottom = SelectionEnd.y;
 
     return SelectionRect;
 }
 
 /// Draws the selection box and additional on-screen information using GDI and GDI+.
+template <typename variant>
 internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
 {
     Gdiplus::Graphics Graphics(DeviceContext);
+    POINT SelectionEnd = GetDisplayedSelectionEnd();
 
     // NOTE: Setup the dashed line pen
     Gdiplus::Pen DashedPen(G_SelectionIsValid ? Gdiplus::Color(255, 79, 223, 78) : Gdiplus::Color(255, 223, 78, 79));
-    DashedPen.SetWidth(3.0f);
+    DashedPen.SetWidth(3.0f * G_DpiScale);
     DashedPen.SetDashStyle(Gdiplus::DashStyle::DashStyleDash);
     DashedPen.SetDashOffset(32.0f);
     DashedPen.SetDashCap(Gdiplus::DashCap::DashCapRound);
 
-    if (G_IsDrawingSelection || G_HasDrawnSelection)
+    if (IsSelectionVisible() || G_HasDrawnSelection)
     {
         // NOTE: Fill selection rectangle
         HBRUSH Brush = CreateSolidBrush(RGB(50, 50, 50));
@@ -151,17 +234,17 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
         Graphics.DrawLine(&DashedPen, End.X, Start.Y, End.X, End.Y); // NOTE: Right
     }
 
-    // NOTE: TextBox properties
+    // NOTE: TextBox properties (sized for 96 DPI, and scaled up on scaled displays)
     // TODO: Move to global constants
-    localpersist r32 TextBoxW = 116.0f;
-    localpersist r32 TextBoxH = 32.0f;
-    localpersist r32 HalfTextBoxW = TextBoxW / 2.0f;
-    localpersist r32 HalfTextBoxH = TextBoxH / 2.0f;
+    r32 TextBoxW = 116.0f * G_DpiScale;
+    r32 TextBoxH = 32.0f * G_DpiScale;
+    r32 HalfTextBoxW = TextBoxW / 2.0f;
+    r32 HalfTextBoxH = TextBoxH / 2.0f;
 
     // NOTE: Font setup
     // TODO: Find a way to check this font is installed on the system, fallback to 'Times New Roman' if not
     Gdiplus::FontFamily FontFamily(L"Ubuntu");
-    Gdiplus::Font Font = Gdiplus::Font(&FontFamily, 24, Gdiplus::FontStyleRegular, Gdiplus::UnitPixel);
+    Gdiplus::Font Font = Gdiplus::Font(&FontFamily, 24.0f * G_DpiScale, Gdiplus::FontStyleRegular, Gdiplus::UnitPixel);
     Gdiplus::SolidBrush TextBrush(Gdiplus::Color(255, 255, 255, 255));
     Gdiplus::SolidBrush EvilTextBrush(Gdiplus::Color(255, 223, 78, 79));
     Gdiplus::SolidBrush HintTextBrush(Gdiplus::Color(255, 236, 206, 91));
@@ -172,40 +255,41 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
     CenterAligned.SetAlignment(Gdiplus::StringAlignmentCenter);
     CenterAligned.SetLineAlignment(Gdiplus::StringAlignmentCenter);
 
-    if (G_IsDrawingSelection)
+    if (IsSelectionVisible())
     {
         if (G_SelectionIsValid)
         {
-            POINT Cursor;
-            GetCursorPos(&Cursor);
-
-            #if PCG_INTERNAL && 0 // TOGGLE: Enable start/end coordinates for debugging
-            // DEBUG: Draw start coordinates
+            if constexpr (variant::DebugOverlay::ShowSelectionCoordinates)
             {
-                Gdiplus::RectF StartRect((r32)G_SelectionStart.x - TextBoxW, (r32)G_SelectionStart.y - TextBoxH, TextBoxW, TextBoxH);
-                std::wstring StartCoordinates = std::to_wstring(G_SelectionStart.x) + L", " + std::to_wstring(G_SelectionStart.y);
-                Graphics.DrawString(StartCoordinates.c_str(), -1, &Font, StartRect, &BottomRightAligned, &TextBrush);
-            }
+                // DEBUG: Draw start coordinates
+                {
+                    Gdiplus::RectF StartRect((r32)G_SelectionStart.x - TextBoxW, (r32)G_SelectionStart.y - TextBoxH, TextBoxW, TextBoxH);
+                    std::wstring StartCoordinates = std::to_wstring(G_SelectionStart.x) + L", " + std::to_wstring(G_SelectionStart.y);
+                    Graphics.DrawString(StartCoordinates.c_str(), -1, &Font, StartRect, &BottomRightAligned, &TextBrush);
+                }
 
-            // DEBUG: Draw end coordinates
-            {
-                Gdiplus::RectF EndRect((r32)G_SelectionEnd.x, (r32)G_SelectionEnd.y, TextBoxW, TextBoxH);
-                std::wstring EndCoordinates = std::to_wstring(G_SelectionEnd.x) + L", " + std::to_wstring(G_SelectionEnd.y);
-                Graphics.DrawString(EndCoordinates.c_str(), -1, &Font, EndRect, 0, &TextBrush);
+                // DEBUG: Draw end coordinates
+                {
+                    Gdiplus::RectF EndRect((r32)SelectionEnd.x, (r32)SelectionEnd.y, TextBoxW, TextBoxH);
+                    std::wstring EndCoordinates = std::to_wstring(SelectionEnd.x) + L", " + std::to_wstring(SelectionEnd.y);
+                    Graphics.DrawString(EndCoordinates.c_str(), -1, &Font, EndRect, 0, &TextBrush);
+                }
             }
-            #endif
 
-            i32 LinePadding = 8;
+            i32 LinePadding = (i32)(8.0f * G_DpiScale + 0.5f);
             DashedPen.SetColor(Gdiplus::Color(255, 255, 255, 255));
 
+            // NOTE: The labels show canvas pixels, while the lines are drawn in monitor pixels
+            canvas_rect SelectionRect = { (i32)G_SelectionStart.x, (i32)G_SelectionStart.y, (i32)SelectionEnd.x, (i32)SelectionEnd.y };
+            canvas_rect CanvasRect;
+            MapRectsToCanvas(&G_CanvasMap, &SelectionRect, &CanvasRect, 1);
+
             // NOTE: X and Y are relative to the center of the TextBox
 
             // NOTE: Draw distance to left screen edge
             {
-                i32 Distance = G_SelectionStart.x;
-
                 r32 X = (r32)(G_SelectionStart.x / 2);
-                r32 Y = (r32)(G_SelectionEnd.y - ((G_SelectionEnd.y - G_SelectionStart.y) / 2));
+                r32 Y = (r32)(SelectionEnd.y - ((SelectionEnd.y - G_SelectionStart.y) / 2));
 
                 b32 DrewLine = false;
 
@@ -219,7 +303,7 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
                 }
 
                 // NOTE: TextBox
-                std::wstring DistanceString = std::to_wstring(Distance) + L" px";
+                std::wstring DistanceString = std::to_wstring(CanvasRect.Left) + L" px";
                 if (DrewLine)
                 {
                     Gdiplus::RectF Rect(X - HalfTextBoxW, Y - HalfTextBoxH, TextBoxW, TextBoxH);
@@ -243,17 +327,17 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
 
             // NOTE: Draw distance to right screen edge
             {
-                i32 Distance = (i32)G_WorkAreaW - G_SelectionEnd.x;
+                i32 Distance = (i32)G_WorkAreaW - SelectionEnd.x;
                 i32 HalfDistance = Distance / 2;
 
-                r32 X = (r32)(G_SelectionEnd.x + HalfDistance);
-                r32 Y = (r32)(G_SelectionEnd.y - ((G_SelectionEnd.y - G_SelectionStart.y) / 2));
+                r32 X = (r32)(SelectionEnd.x + HalfDistance);
+                r32 Y = (r32)(SelectionEnd.y - ((SelectionEnd.y - G_SelectionStart.y) / 2));
 
                 b32 DrewLine = false;
 
                 // NOTE: Left dashed line
-                i32 LineStartX = G_SelectionEnd.x + LinePadding;
-                i32 LineEndX = G_SelectionEnd.x + HalfDistance - (i32)HalfTextBoxW - LinePadding;
+                i32 LineStartX = SelectionEnd.x + LinePadding;
+                i32 LineEndX = SelectionEnd.x + HalfDistance - (i32)HalfTextBoxW - LinePadding;
                 if (LineEndX > LineStartX)
                 {
                     Graphics.DrawLine(&DashedPen, LineStartX, (i32)Y, LineEndX, (i32)Y);
@@ -270,7 +354,7 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
                 }
 
                 // NOTE: TextBox
-                std::wstring DistanceString = std::to_wstring(Distance) + L" px";
+                std::wstring DistanceString = std::to_wstring(G_CanvasMap.CanvasW - CanvasRect.Right) + L" px";
                 if (DrewLine)
                 {
                     Gdiplus::RectF Rect(X - HalfTextBoxW, Y - HalfTextBoxH, TextBoxW, TextBoxH);
@@ -278,7 +362,7 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
                 }
                 else
                 {
-                    Gdiplus::RectF Rect((r32)(Cursor.x - LinePadding) - TextBoxW, Y - HalfTextBoxH, TextBoxW, TextBoxH);
+                    Gdiplus::RectF Rect((r32)(End.X - LinePadding) - TextBoxW, Y - HalfTextBoxH, TextBoxW, TextBoxH);
                     Graphics.DrawString(DistanceString.c_str(), -1, &Font, Rect, &CenterAligned, &TextBrush);
                 }
             }
@@ -288,7 +372,7 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
                 i32 Distance = G_SelectionStart.y;
                 i32 HalfDistance = Distance / 2;
 
-                r32 X = (r32)(G_SelectionStart.x + ((G_SelectionEnd.x - G_SelectionStart.x) / 2));
+                r32 X = (r32)(G_SelectionStart.x + ((SelectionEnd.x - G_SelectionStart.x) / 2));
                 r32 Y = (r32)(G_SelectionStart.y / 2);
 
                 b32 DrewLine = false;
@@ -303,7 +387,7 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
                 }
 
                 // NOTE: TextBox
-                std::wstring DistanceString = std::to_wstring(Distance) + L" px";
+                std::wstring DistanceString = std::to_wstring(CanvasRect.Top) + L" px";
                 if (DrewLine)
                 {
                     Gdiplus::RectF Rect(X - HalfTextBoxW, Y - HalfTextBoxH, TextBoxW, TextBoxH);
@@ -327,16 +411,16 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
 
             // NOTE: Draw distance to bottom screen edge
             {
-                i32 Distance = (i32)G_WorkAreaH - G_SelectionEnd.y;
+                i32 Distance = (i32)G_WorkAreaH - SelectionEnd.y;
                 i32 HalfDistance = Distance / 2;
 
-                r32 X = (r32)(G_SelectionStart.x + ((G_SelectionEnd.x - G_SelectionStart.x) / 2));
-                r32 Y = (r32)(G_SelectionEnd.y + ((G_WorkAreaH - G_SelectionEnd.y) / 2));
+                r32 X = (r32)(G_SelectionStart.x + ((SelectionEnd.x - G_SelectionStart.x) / 2));
+                r32 Y = (r32)(SelectionEnd.y + ((G_WorkAreaH - SelectionEnd.y) / 2));
 
                 b32 DrewLine = false;
 
                 // NOTE: Top dashed line
-                i32 LineStartY = G_SelectionEnd.y + LinePadding;
+                i32 LineStartY = SelectionEnd.y + LinePadding;
                 i32 LineEndY = (i32)G_WorkAreaH - HalfDistance - (i32)HalfTextBoxH - LinePadding;
                 if (LineEndY > LineStartY)
                 {
@@ -354,7 +438,7 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
                 }
 
                 // NOTE: TextBox
-                std::wstring DistanceString = std::to_wstring(Distance) + L" px";
+                std::wstring DistanceString = std::to_wstring(G_CanvasMap.CanvasH - CanvasRect.Bottom) + L" px";
                 if (DrewLine)
                 {
                     Gdiplus::RectF Rect(X - HalfTextBoxW, Y - HalfTextBoxH, TextBoxW, TextBoxH);
@@ -362,7 +446,7 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
                 }
                 else
                 {
-                    Gdiplus::RectF Rect(X - HalfTextBoxW, (r32)(Cursor.y - LinePadding) - TextBoxH, TextBoxW, TextBoxH);
+                    Gdiplus::RectF Rect(X - HalfTextBoxW, (r32)(End.Y - LinePadding) - TextBoxH, TextBoxW, TextBoxH);
                     Graphics.DrawString(DistanceString.c_str(), -1, &Font, Rect, &CenterAligned, &TextBrush);
                 }
             }
@@ -373,8 +457,8 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
             CenterBottomAligned.SetAlignment(Gdiplus::StringAlignmentCenter);
             CenterBottomAligned.SetLineAlignment(Gdiplus::StringAlignmentFar);
 
-            Gdiplus::RectF InvalidRectRect(0.0f, 0.0f, G_WorkAreaW, G_WorkAreaH - 80.0f);
-            std::wstring InvalidRectText = L"Invalid Rectangle! Must be larger than " + std::to_wstring(MinSize) + L" x " + std::to_wstring(MinSize) + L" pixels";
+            Gdiplus::RectF InvalidRectRect(0.0f, 0.0f, G_WorkAreaW, G_WorkAreaH - 80.0f * G_DpiScale);
+            std::wstring InvalidRectText = L"Invalid Rectangle! Must be larger than " + std::to_wstring(GetMinSelectionSize()) + L" x " + std::to_wstring(GetMinSelectionSize()) + L" pixels";
             Graphics.DrawString(InvalidRectText.c_str(), -1, &Font, InvalidRectRect, &CenterBottomAligned, &EvilTextBrush);
         }
     }
@@ -384,8 +468,10 @@ internal void PaintSelection(HDC DeviceContext, rect2i Start, rect2i End)
         CenterBottomAligned.SetAlignment(Gdiplus::StringAlignmentCenter);
         CenterBottomAligned.SetLineAlignment(Gdiplus::StringAlignmentFar);
 
-        Gdiplus::RectF InvalidRectRect(0.0f, 0.0f, G_WorkAreaW, G_WorkAreaH - 80.0f);
-        std::wstring InvalidRectText = L"Click and drag to draw a selection, or press [Escape] or [Right Mouse Button] to cancel";
+        Gdiplus::RectF InvalidRectRect(0.0f, 0.0f, G_WorkAreaW, G_WorkAreaH - 80.0f * G_DpiScale);
+        std::wstring InvalidRectText = G_IsPickingWindow ?
+            L"Click a window to select it, press [W] to draw a selection, or press [Escape] or [Right Mouse Button] to cancel" :
+            L"Click and drag to draw a selection, press [W] to pick a window, or press [Escape] or [Right Mouse Button] to cancel";
         Graphics.DrawString(InvalidRectText.c_str(), -1, &Font, InvalidRectRect, &CenterBottomAligned, &HintTextBrush);
     }
 }
@@ -395,38 +481,105 @@ internal void Repaint(HWND Window)
     InvalidateRect(Window, 0, TRUE);
 }
 
-// NOTE: Suppress 'unreferenced formal parameter' warning for Window; it is used for Repaint()
-#pragma warning ( push )
-#pragma warning ( disable: 4100 )
-/// Updates the selection rectangle and issues a redraw request if it has changed.
+/// Moves the end of the selection rectangle and issues a redraw request if it has changed.
+/// NOTE: Window is only used by the pacing policies that repaint on change
+template <typename variant>
+internal void SetSelectionEnd([[maybe_unused]] HWND Window, POINT End)
+{
+    if constexpr (variant::Pacing::RepaintOnChange)
+    {
+        if (ArePointsDifferent(G_SelectionEnd, End))
+        {
+            // NOTE: Invalidate the entire client area, to force a redraw (painted once this message is handled)
+            Repaint(Window);
+        }
+    }
+
+    G_SelectionEnd = End;
+    G_DisplayEnd = End; // NOTE: Until a paint predicts further ahead
+
+    // NOTE: Always re-evaluated, since the start may have moved too
+    i32 MinSelectionSize = GetMinSelectionSize();
+    G_SelectionIsValid = ((G_SelectionEnd.x - G_SelectionStart.x) >= MinSelectionSize &&
+                          (G_SelectionEnd.y - G_SelectionStart.y) >= MinSelectionSize);
+}
+
+/// Moves the end of the selection rectangle to the (real) cursor position.
+template <typename variant>
 internal void UpdateSelection(HWND Window)
-#pragma warning ( pop )
 {
-    POINT PreviousStart = G_SelectionStart;
-    POINT PreviousEnd = G_SelectionEnd;
+    POINT Cursor;
+    GetCursorPos(&Cursor);
+    ScreenToClient(Window, &Cursor);
+    AddCursorSample(&G_CursorPredictor, GetSeconds(), Cursor.x, Cursor.y);
 
-    POINT PointA = G_SelectionStart;
-    POINT PointB;
-    GetCursorPos(&PointB);
-    ScreenToClient(Window, &PointB);
+    SetSelectionEnd<variant>(Window, Cursor);
+}
 
-    G_SelectionStart = PointA;
-    G_SelectionEnd = PointB;
+/// Samples the cursor as the frame is painted, and moves the displayed selection end to where the cursor is
+/// expected to be once the frame is shown. The real selection end (and whether it's valid) is left alone.
+/// NOTE: Only with pacing that keeps repainting, so the prediction settles once the cursor stops
+template <typename variant>
+internal void PredictSelectionEnd([[maybe_unused]] HWND Window)
+{
+    if constexpr (variant::Pacing::PredictsCursor)
+    {
+        POINT Cursor;
+        GetCursorPos(&Cursor);
+        ScreenToClient(Window, &Cursor);
+        r64 Now = GetSeconds();
+        AddCursorSample(&G_CursorPredictor, Now, Cursor.x, Cursor.y);
+
+        // NOTE: A frame painted now is shown at the next refresh at the earliest
+        r64 PresentTime = Now + 1.0 / (r64)G_MonitorRefreshHz;
+        i32 X;
+        i32 Y;
+        if (PredictCursor(&G_CursorPredictor, PresentTime, &X, &Y))
+        {
+            G_DisplayEnd.x = Min(Max(X, 0), (i32)G_WorkAreaW);
+            G_DisplayEnd.y = Min(Max(Y, 0), (i32)G_WorkAreaH);
+        }
+    }
+}
 
-    if (ArePointsDifferent(PreviousStart, G_SelectionStart) || ArePointsDifferent(PreviousEnd, G_SelectionEnd))
+internal i32 GetMonitorRefreshHz(HWND Window)
+{
+    i32 MonitorRefreshHz = 60;
+    HDC RefreshDC = GetDC(Window);
+    i32 Win32RefreshRate = GetDeviceCaps(RefreshDC, VREFRESH);
+    ReleaseDC(Window, RefreshDC);
+    if (Win32RefreshRate > 1)
     {
-        G_SelectionIsValid = ((G_SelectionEnd.x - G_SelectionStart.x) >= MinSize &&
-                              (G_SelectionEnd.y - G_SelectionStart.y) >= MinSize);
+        MonitorRefreshHz = Win32RefreshRate;
+    }
+
+    return MonitorRefreshHz;
+}
 
-        #if PCG_ATTEMPT_VSYNC == 0
-        // NOTE: Invalidate the entire client area, to force a redraw
-        Repaint(Window);
-        #endif
+/// Returns the DPI of the monitor the window is on, relative to the 96 DPI the overlay's sizes are designed for.
+internal r32 GetWindowDpiScale(HWND Window)
+{
+    // NOTE: GetDpiForWindow needs Windows 10 1607, so it's looked up at runtime; before that, the system DPI
+    // is the best there is
+    typedef UINT WINAPI get_dpi_for_window(HWND Window);
+    get_dpi_for_window *GetDpiForWindowFunction =
+        (get_dpi_for_window *)(void *)GetProcAddress(GetModuleHandleA("user32.dll"), "GetDpiForWindow");
+    i32 Dpi = GetDpiForWindowFunction ? (i32)GetDpiForWindowFunction(Window) : 0;
+    if (Dpi <= 0)
+    {
+        HDC DpiDC = GetDC(Window);
+        Dpi = GetDeviceCaps(DpiDC, LOGPIXELSX);
+        ReleaseDC(Window, DpiDC);
     }
+
+    return (Dpi > 0) ? (r32)Dpi / 96.0f : 1.0f;
 }
 
+template <typename variant>
 internal void UpdateMonitorStats(HWND Window)
 {
+    typedef typename variant::Instrumentation instrumentation;
+
     G_WindowMonitor = MonitorFromWindow(Window, MONITOR_DEFAULTTOPRIMARY);
     MONITORINFO MonitorInfo = { sizeof(MONITORINFO) };
     if (GetMonitorInfoA(G_WindowMonitor, &MonitorInfo))
@@ -434,39 +587,49 @@ internal void UpdateMonitorStats(HWND Window)
         G_WorkAreaW = (r32)(MonitorInfo.rcWork.right - MonitorInfo.rcWork.left);
         G_WorkAreaH = (r32)(MonitorInfo.rcWork.bottom - MonitorInfo.rcWork.top);
 
-        #if PCG_INTERNAL
-        std::string MonitorStats = "Monitor size: " + std::to_string((i32)G_WorkAreaW) + " x " + std::to_string((i32)G_WorkAreaH) + " px\n";
-        OutputDebugStringA(MonitorStats.c_str());
-        #endif
+        if constexpr (instrumentation::Enabled)
+        {
+            std::string MonitorStats = "Monitor size: " + std::to_string((i32)G_WorkAreaW) + " x " + std::to_string((i32)G_WorkAreaH) + " px\n";
+            instrumentation::Log(MonitorStats.c_str());
+        }
 
-        #if PCG_ATTEMPT_VSYNC
-        // NOTE: Attempt to make the program refresh in time with V-Sync (this is not *ACTUALLY* V-Sync, only an approximation!)
-        i32 MonitorRefreshHz = 60;
-        HDC RefreshDC = GetDC(Window);
-        i32 Win32RefreshRate = GetDeviceCaps(RefreshDC, VREFRESH);
-        ReleaseDC(Window, RefreshDC);
-        if (Win32RefreshRate > 1)
+        // NOTE: The DPI is per-monitor (the window has already been moved onto this one)
+        G_DpiScale = GetWindowDpiScale(Window);
+
+        if constexpr (instrumentation::Enabled)
         {
-            MonitorRefreshHz = Win32RefreshRate;
+            std::string DpiMessage = "Monitor DPI scale: " + std::to_string((i32)(G_DpiScale * 100.0f + 0.5f)) + "%\n";
+            instrumentation::Log(DpiMessage.c_str());
         }
 
-        SetTimer(Window, 999, 1000 / MonitorRefreshHz, NULL);
+        // NOTE: The refresh rate is per-monitor, so the frame timer (if any) is restarted here
+        G_MonitorRefreshHz = GetMonitorRefreshHz(Window);
+        variant::Pacing::StartFrameTimer(Window, G_MonitorRefreshHz);
 
-        #if PCG_INTERNAL
-        std::string RefreshRateMessage = "Monitor refresh rate: " + std::to_string(MonitorRefreshHz) + "\n";
-        OutputDebugStringA(RefreshRateMessage.c_str());
-        #endif
-        #endif
+        if constexpr (instrumentation::Enabled)
+        {
+            std::string RefreshRateMessage = "Monitor refresh rate: " + std::to_string(G_MonitorRefreshHz) + "\n";
+            instrumentation::Log(RefreshRateMessage.c_str());
+        }
     }
     else
     {
-        #if PCG_INTERNAL
-        OutputDebugStringA("ERROR: Failed to update the monitor stats!\n");
-        #endif
+        instrumentation::Log("ERROR: Failed to update the monitor stats!\n");
+    }
+
+    // NOTE: The canvas tables only depend on the work area, so they're rebuilt here rather than per frame.
+    // Even if the monitor info couldn't be read, the labels and results always need a map to look up.
+    BuildCanvasMap(&G_CanvasMap, (i32)G_WorkAreaW, (i32)G_WorkAreaH, G_CanvasW, G_CanvasH);
+
+    if constexpr (instrumentation::Enabled)
+    {
+        std::string CanvasStats = "Canvas size: " + std::to_string(G_CanvasMap.CanvasW) + " x " + std::to_string(G_CanvasMap.CanvasH) + " px\n";
+        instrumentation::Log(CanvasStats.c_str());
     }
 }
 
 /// Updates the window position (for when the window should move to the monitor the cursor is on).
+template <typename variant>
 internal void UpdateWindowPosition(HWND Window)
 {
     MONITORINFO MonitorInfo = { sizeof(MONITORINFO) };
@@ -485,17 +648,414 @@ internal void UpdateWindowPosition(HWND Window)
                          MonitorInfo.rcWork.bottom - MonitorInfo.rcWork.top,
                          SWP_NOOWNERZORDER | SWP_FRAMECHANGED);
             G_WindowMonitor = Monitor;
-            UpdateMonitorStats(Window);
+            UpdateMonitorStats<variant>(Window);
+        }
+        else
+        {
+            variant::Instrumentation::Log("ERROR: Failed to get the monitor info!\n");
+        }
+    }
+}
+
+/// Gets the visible bounds of a top-level window, returning false if it can't be picked.
+internal b32 GetPickableWindowEntry(HWND Candidate, window_entry *Entry)
+{
+    if (Candidate == G_OverlayWindow || Candidate == GetShellWindow() ||
+        !IsWindowVisible(Candidate) || IsIconic(Candidate))
+    {
+        return false;
+    }
+
+    // NOTE: Cloaked windows are hidden by DWM (e.g. they're on another virtual desktop)
+    DWORD Cloaked = 0;
+    if (SUCCEEDED(DwmGetWindowAttribute(Candidate, DWMWA_CLOAKED, &Cloaked, sizeof(Cloaked))) && Cloaked)
+    {
+        return false;
+    }
+
+    // NOTE: The extended frame bounds exclude the invisible resize borders that GetWindowRect includes
+    RECT Bounds;
+    if (FAILED(DwmGetWindowAttribute(Candidate, DWMWA_EXTENDED_FRAME_BOUNDS, &Bounds, sizeof(Bounds))) &&
+        !GetWindowRect(Candidate, &Bounds))
+    {
+        return false;
+    }
+
+    Entry->Id = (u64)(uintptr_t)Candidate;
+    Entry->Left = Bounds.left;
+    Entry->Top = Bounds.top;
+    Entry->Right = Bounds.right;
+    Entry->Bottom = Bounds.bottom;
+
+    return !IsWindowEntryEmpty(Entry);
+}
+
+internal BOOL CALLBACK SnapshotWindowCallback(HWND Candidate, [[maybe_unused]] LPARAM LParam)
+{
+    window_entry Entry;
+    if (GetPickableWindowEntry(Candidate, &Entry))
+    {
+        G_WindowSnapshot.Entries.push_back(Entry);
+    }
+
+    return TRUE;
+}
+
+/// Takes a snapshot of every pickable top-level window (EnumWindows goes through them front-to-back).
+internal void SnapshotTopLevelWindows()
+{
+    G_WindowSnapshot.Entries.clear();
+    EnumWindows(SnapshotWindowCallback, 0);
+    G_WindowSnapshot.IsDirty = true;
+}
+
+/// Returns the ID of the nearest window above the given one in the z-order that is in the snapshot,
+/// or 0 if there isn't one (it is the front-most pickable window).
+internal u64 FindSnapshotWindowAbove(HWND Candidate)
+{
+    for (HWND Above = GetWindow(Candidate, GW_HWNDPREV); Above; Above = GetWindow(Above, GW_HWNDPREV))
+    {
+        u64 AboveId = (u64)(uintptr_t)Above;
+        if (FindSnapshotWindow(&G_WindowSnapshot, AboveId) >= 0)
+        {
+            return AboveId;
+        }
+    }
+
+    return 0;
+}
+
+/// Keeps the window snapshot up to date as windows move, open, close, get activated and change z-order.
+internal void CALLBACK WindowEventCallback([[maybe_unused]] HWINEVENTHOOK Hook, DWORD Event, HWND EventWindow,
+                                          LONG ObjectId, LONG ChildId,
+                                          [[maybe_unused]] DWORD EventThread, [[maybe_unused]] DWORD EventTime)
+{
+    // NOTE: Z-order changes that don't activate anything (e.g. SWP_NOACTIVATE, or toggling always-on-top) are
+    // only reported as a reorder of the container, which doesn't say which window moved, so the snapshot is
+    // retaken on the next index refresh. Reorders inside a window don't change which one is on top, but
+    // can't be told apart from the top-level ones reported against the window itself.
+    if (Event == EVENT_OBJECT_REORDER)
+    {
+        if (!EventWindow || EventWindow == GetDesktopWindow() || GetAncestor(EventWindow, GA_ROOT) == EventWindow)
+        {
+            G_WindowOrderIsStale = true;
+        }
+        return;
+    }
+
+    // NOTE: Only interested in the windows themselves, not the objects inside them
+    if (!EventWindow || ObjectId != OBJID_WINDOW || ChildId != CHILDID_SELF)
+    {
+        return;
+    }
+
+    u64 Id = (u64)(uintptr_t)EventWindow;
+    switch (Event)
+    {
+        case EVENT_OBJECT_DESTROY:
+        case EVENT_OBJECT_HIDE:
+        case EVENT_OBJECT_CLOAKED:
+        case EVENT_SYSTEM_MINIMIZESTART:
+        {
+            RemoveSnapshotWindow(&G_WindowSnapshot, Id);
+        }
+        break;
+        case EVENT_SYSTEM_FOREGROUND:
+        case EVENT_OBJECT_SHOW:
+        case EVENT_OBJECT_UNCLOAKED:
+        case EVENT_SYSTEM_MINIMIZEEND:
+        case EVENT_OBJECT_LOCATIONCHANGE:
+        {
+            window_entry Entry;
+            if (GetAncestor(EventWindow, GA_ROOT) != EventWindow)
+            {
+                // NOTE: Not a top-level window
+            }
+            else if (GetPickableWindowEntry(EventWindow, &Entry))
+            {
+                // NOTE: The z-order is re-queried rather than assumed, since a window that is shown, moved or
+                // activated isn't necessarily on top (e.g. it opened behind others, or there are topmost windows)
+                UpdateSnapshotWindow(&G_WindowSnapshot, Entry, FindSnapshotWindowAbove(EventWindow));
+            }
+            else
+            {
+                RemoveSnapshotWindow(&G_WindowSnapshot, Id);
+            }
+        }
+        break;
+    }
+}
+
+/// Rebuilds the window index if the snapshot changed since the last rebuild (retaking the snapshot first if
+/// the z-order went stale).
+/// NOTE: A rebuild takes milliseconds with hundreds of windows, so this runs on the window index timer (and
+/// when picking starts or a window is clicked), never per mouse move. Bursts of window events only cost one.
+internal void RefreshWindowIndex()
+{
+    if (G_WindowOrderIsStale)
+    {
+        SnapshotTopLevelWindows();
+        G_WindowOrderIsStale = false;
+    }
+
+    if (G_WindowSnapshot.IsDirty)
+    {
+        // NOTE: The index refers to entries by position, so it keeps its own copy of them
+        G_IndexedWindows = G_WindowSnapshot.Entries;
+        BuildWindowIndex(&G_WindowIndex, G_IndexedWindows.data(), (u32)G_IndexedWindows.size());
+        G_WindowSnapshot.IsDirty = false;
+
+        // NOTE: Entries may have moved, so make sure the selection is refreshed
+        G_HoveredWindow = -1;
+    }
+}
+
+/// Makes the window under the cursor the current selection (window picker mode).
+/// NOTE: Only hit-tests the index, which RefreshWindowIndex keeps up to date
+template <typename variant>
+internal void UpdateHoveredWindow(HWND Window)
+{
+    POINT Cursor;
+    GetCursorPos(&Cursor);
+    i32 HoveredWindow = WindowIndexHitTest(&G_WindowIndex, Cursor.x, Cursor.y);
+
+    if (HoveredWindow != G_HoveredWindow)
+    {
+        G_HoveredWindow = HoveredWindow;
+
+        if (HoveredWindow >= 0)
+        {
+            const window_entry *Entry = &G_IndexedWindows[HoveredWindow];
+            POINT TopLeft = { Entry->Left, Entry->Top };
+            POINT BottomRight = { Entry->Right, Entry->Bottom };
+            ScreenToClient(Window, &TopLeft);
+            ScreenToClient(Window, &BottomRight);
+
+            // NOTE: Clip to the work area, so none of the offsets are negative
+            G_SelectionStart.x = Max(TopLeft.x, 0);
+            G_SelectionStart.y = Max(TopLeft.y, 0);
+            G_SelectionEnd.x = Min(BottomRight.x, (i32)G_WorkAreaW);
+            G_SelectionEnd.y = Min(BottomRight.y, (i32)G_WorkAreaH);
+
+            i32 MinSelectionSize = GetMinSelectionSize();
+            G_SelectionIsValid = ((G_SelectionEnd.x - G_SelectionStart.x) >= MinSelectionSize &&
+                                  (G_SelectionEnd.y - G_SelectionStart.y) >= MinSelectionSize);
         }
         else
         {
-            #if PCG_INTERNAL
-            OutputDebugStringA("ERROR: Failed to get the monitor info!\n");
-            #endif
+            G_SelectionStart = { };
+            G_SelectionEnd = { };
+            G_SelectionIsValid = false;
         }
+
+        if constexpr (variant::Pacing::RepaintOnChange)
+        {
+            Repaint(Window);
+        }
+    }
+}
+
+/// Draws a full frame (background and selection) into the given device context.
+template <typename variant>
+internal void PaintFrame(HDC DeviceContext, RECT ClientRect)
+{
+    typename variant::RenderBackend::frame Frame = variant::RenderBackend::BeginFrame(DeviceContext, &ClientRect);
+
+    // NOTE: Draw the translucent window background
+    localpersist HBRUSH WindowBGBrush = CreateSolidBrush(RGB(20, 20, 20));
+    FillRect(Frame.DeviceContext, &ClientRect, WindowBGBrush);
+
+    if (IsSelectionVisible())
+    {
+        // NOTE: Draw the selection rectangle outline
+        POINT SelectionEnd = GetDisplayedSelectionEnd();
+
+        rect2i Start;
+        Start.X = Min(G_SelectionStart.x, SelectionEnd.x);
+        Start.Y = Min(G_SelectionStart.y, SelectionEnd.y);
+
+        rect2i End;
+        End.X = Max(G_SelectionStart.x, SelectionEnd.x);
+        End.Y = Max(G_SelectionStart.y, SelectionEnd.y);
+
+        PaintSelection<variant>(Frame.DeviceContext, Start, End);
     }
+    else
+    {
+        rect2i Start = { };
+        rect2i End = { };
+        PaintSelection<variant>(Frame.DeviceContext, Start, End);
+    }
+
+    variant::RenderBackend::EndFrame(&Frame);
 }
 
+internal b32 WritePngToFile(void *Context, const u8 *Data, u32 Size)
+{
+    DWORD BytesWritten;
+    return WriteFile((HANDLE)Context, Data, Size, &BytesWritten, NULL) && BytesWritten == Size;
+}
+
+/// The (approximate) size of the bitmap the exported frame is rendered into, a band of rows at a time.
+const u32 ExportBandBytes = 4 << 20;
+
+/// Renders the final frame (the given selection, outline, guide lines and offsets) off-screen at full
+/// resolution, and streams it to a PNG file row by row.
+/// NOTE: The frame is rendered in horizontal bands, so memory use doesn't grow with the monitor size
+template <typename variant>
+internal b32 ExportAnnotatedLayout(HWND Window, const pcg_cam_result *Selection, const char *Path)
+{
+    // NOTE: The bands are painted straight into their bitmap; there is nothing on screen to flicker
+    typedef pcg_variant<typename variant::Instrumentation, typename variant::Pacing,
+                        render_direct, typename variant::DebugOverlay> export_variant;
+
+    RECT ClientRect = { 0, 0, (LONG)G_WorkAreaW, (LONG)G_WorkAreaH };
+    u32 Width = (u32)Max(ClientRect.right, 1);
+    u32 Height = (u32)Max(ClientRect.bottom, 1);
+    u32 BandHeight = Min(Max(ExportBandBytes / (Width * 4), 1u), Height);
+
+    BITMAPINFO BitmapInfo = { };
+    BitmapInfo.bmiHeader.biSize = sizeof(BitmapInfo.bmiHeader);
+    BitmapInfo.bmiHeader.biWidth = (LONG)Width;
+    BitmapInfo.bmiHeader.biHeight = -(LONG)BandHeight; // NOTE: Negative for a top-down bitmap
+    BitmapInfo.bmiHeader.biPlanes = 1;
+    BitmapInfo.bmiHeader.biBitCount = 32;
+    BitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+    HDC WindowDC = GetDC(Window);
+    HDC BandDC = CreateCompatibleDC(WindowDC);
+    ReleaseDC(Window, WindowDC);
+
+    void *Pixels = 0;
+    HBITMAP BandBitmap = CreateDIBSection(BandDC, &BitmapInfo, DIB_RGB_COLORS, &Pixels, NULL, 0);
+    if (!BandBitmap)
+    {
+        DeleteDC(BandDC);
+        variant::Instrumentation::Log("ERROR: Failed to create the export bitmap!\n");
+        return false;
+    }
+    HGDIOBJ PreviousBitmap = SelectObject(BandDC, BandBitmap);
+
+    b32 Result = false;
+    HANDLE File = CreateFileA(Path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (File != INVALID_HANDLE_VALUE)
+    {
+        png_encoder Encoder = { };
+        if (BeginPngEncode(&Encoder, Width, Height, 3, WritePngToFile, File, 0))
+        {
+            std::vector<u8> Row((size_t)Width * 3);
+            b32 WroteRows = true;
+
+            // NOTE: Paint the selection the results were shown for, whatever the globals were set to since
+            G_SelectionStart = { Selection->Left, Selection->Top };
+            G_SelectionEnd = { Selection->Right, Selection->Bottom };
+            G_SelectionIsValid = Selection->IsValid;
+
+            G_IsExporting = true;
+            for (u32 BandTop = 0; WroteRows && BandTop < Height; BandTop += BandHeight)
+            {
+                // NOTE: Shift the whole frame up, so this band lands in the bitmap (and the rest is clipped).
+                // GDI+ picks up the viewport origin of the DC its Graphics are created from too.
+                SetViewportOrgEx(BandDC, 0, -(i32)BandTop, NULL);
+                PaintFrame<export_variant>(BandDC, ClientRect);
+                GdiFlush();
+
+                u32 BandRows = Min(BandHeight, Height - BandTop);
+                for (u32 Y = 0; WroteRows && Y < BandRows; ++Y)
+                {
+                    // NOTE: GDI gives us BGRX, the PNG is RGB
+                    const u8 *Source = (const u8 *)Pixels + (size_t)Y * Width * 4;
+                    for (u32 X = 0; X < Width; ++X)
+                    {
+                        Row[X * 3 + 0] = Source[X * 4 + 2];
+                        Row[X * 3 + 1] = Source[X * 4 + 1];
+                        Row[X * 3 + 2] = Source[X * 4 + 0];
+                    }
+                    WroteRows = WritePngRow(&Encoder, Row.data());
+                }
+            }
+            G_IsExporting = false;
+
+            Result = EndPngEncode(&Encoder) && WroteRows;
+        }
+        CloseHandle(File);
+
+        if (!Result)
+        {
+            DeleteFileA(Path);
+        }
+    }
+
+    SelectObject(BandDC, PreviousBitmap);
+    DeleteObject(BandBitmap);
+    DeleteDC(BandDC);
+
+    return Result;
+}
+
+/// Shows the offsets of the current selection to the user (offering to export the annotated layout),
+/// then closes the program.
+template <typename variant>
+internal void ShowSelectionResult(HWND Window)
+{
+    // NOTE: The dialogs below run their own message loops, which keep delivering WM_TIMER here. Picking stops
+    // first, so the hovered window can't replace the selection, and the export paints from this copy.
+    if (G_IsPickingWindow)
+    {
+        G_IsPickingWindow = false;
+        KillTimer(Window, WindowIndexTimerId);
+    }
+    pcg_cam_result FinalSelection = { G_SelectionIsValid, (i32)G_SelectionStart.x, (i32)G_SelectionStart.y,
+                                      (i32)G_SelectionEnd.x, (i32)G_SelectionEnd.y };
+
+    canvas_rect SelectionRect = { FinalSelection.Left, FinalSelection.Top, FinalSelection.Right, FinalSelection.Bottom };
+    canvas_rect CanvasRect;
+    MapRectsToCanvas(&G_CanvasMap, &SelectionRect, &CanvasRect, 1);
+
+    i32 Left = CanvasRect.Left;
+    i32 Top = CanvasRect.Top;
+    i32 Right = G_CanvasMap.CanvasW - CanvasRect.Right;
+    i32 Bottom = G_CanvasMap.CanvasH - CanvasRect.Bottom;
+
+    std::string ResultMessage =
+        "Left:\t  " + std::to_string(Left) +
+        "\nTop:\t  " + std::to_string(Top) +
+        "\nRight:\t  " + std::to_string(Right) +
+        "\nBottom:\t  " + std::to_string(Bottom) +
+        "                                          "; // NOTE: Widen the box a little
+    if (IsCanvasMapScaled(&G_CanvasMap))
+    {
+        ResultMessage += "\n\n(On a " + std::to_string(G_CanvasMap.CanvasW) + " x " + std::to_string(G_CanvasMap.CanvasH) + " canvas)";
+    }
+    ResultMessage += "\n\nSave an annotated image of the layout?";
+
+    // NOTE: Make the window invisible
+    SetLayeredWindowAttributes(Window, RGB(0, 0, 0), 0, LWA_ALPHA);
+
+    // NOTE: Show the data to the user
+    // TODO: Find a way to make this wider?
+    if (MessageBox(Window, ResultMessage.c_str(), "PCG Cam Utility Results", MB_YESNO | MB_TOPMOST) == IDYES)
+    {
+        char Path[MAX_PATH] = "layout.png";
+        OPENFILENAMEA SaveDialog = { sizeof(SaveDialog) };
+        SaveDialog.hwndOwner = Window;
+        SaveDialog.lpstrFilter = "PNG Image (*.png)\0*.png\0";
+        SaveDialog.lpstrFile = Path;
+        SaveDialog.nMaxFile = sizeof(Path);
+        SaveDialog.lpstrDefExt = "png";
+        SaveDialog.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST | OFN_NOCHANGEDIR;
+
+        if (GetSaveFileNameA(&SaveDialog) && !ExportAnnotatedLayout<variant>(Window, &FinalSelection, Path))
+        {
+            MessageBox(Window, "Failed to export the annotated layout!", "PCG Cam Utility", MB_OK | MB_ICONERROR | MB_TOPMOST);
+        }
+    }
+
+    // NOTE: Close the app
+    G_Running = false;
+}
+
+template <typename variant>
 LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam, LPARAM LParam)
 {
     LRESULT Result = 0;
@@ -529,6 +1089,26 @@ LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam
                     PostQuitMessage(0);
                     G_Running = false;
                 }
+
+                // NOTE: Toggle the window picker on W pressed
+                if (VKCode == 'W' && IsDown && !G_IsDrawingSelection)
+                {
+                    G_IsPickingWindow = !G_IsPickingWindow;
+                    G_HoveredWindow = -1;
+                    G_SelectionStart = { };
+                    G_SelectionEnd = { };
+                    if (G_IsPickingWindow)
+                    {
+                        SetTimer(Window, WindowIndexTimerId, WindowIndexTimerMs, NULL);
+                        RefreshWindowIndex();
+                        UpdateHoveredWindow<variant>(Window);
+                    }
+                    else
+                    {
+                        KillTimer(Window, WindowIndexTimerId);
+                    }
+                    Repaint(Window);
+                }
             }
         }
         break;
@@ -541,18 +1121,41 @@ LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam
         break;
         case WM_TIMER:
         {
-            Repaint(Window);
+            if (WParam == WindowIndexTimerId)
+            {
+                // NOTE: Picks up windows that changed since the last tick (including under a stationary cursor)
+                if (G_IsPickingWindow)
+                {
+                    RefreshWindowIndex();
+                    UpdateHoveredWindow<variant>(Window);
+                }
+            }
+            else
+            {
+                Repaint(Window);
+            }
         }
         break;
         case WM_LBUTTONDOWN:
         case WM_NCLBUTTONDOWN:
         {
-            if (!G_IsDrawingSelection)
+            if (G_IsPickingWindow)
+            {
+                RefreshWindowIndex();
+                UpdateHoveredWindow<variant>(Window);
+                if (G_HoveredWindow >= 0 && G_SelectionIsValid)
+                {
+                    G_HasDrawnSelection = true;
+                    ShowSelectionResult<variant>(Window);
+                }
+            }
+            else if (!G_IsDrawingSelection)
             {
                 GetCursorPos(&G_SelectionStart);
                 ScreenToClient(Window, &G_SelectionStart);
                 G_IsDrawingSelection = true;
-                UpdateSelection(Window);
+                ResetCursorPredictor(&G_CursorPredictor);
+                UpdateSelection<variant>(Window);
             }
         }
         break;
@@ -563,41 +1166,19 @@ LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam
             {
                 G_IsDrawingSelection = false;
                 G_HasDrawnSelection = true; // TODO: Remove this?
-                UpdateSelection(Window); // NOTE: Needed to ensure G_SelectionIsValid is accurate
+                // NOTE: Takes the end from the real cursor position (only the drawn end is predicted while dragging),
+                // and ensures G_SelectionIsValid is accurate
+                UpdateSelection<variant>(Window);
 
                 if (G_HasDrawnSelection && G_SelectionIsValid)
                 {
-                    #if PCG_INTERNAL
-                    OutputDebugStringA("Selection is valid\n");
-                    #endif
-
-                    i32 Left = G_SelectionStart.x;
-                    i32 Top = G_SelectionStart.y;
-                    i32 Right = (i32)G_WorkAreaW - G_SelectionEnd.x;
-                    i32 Bottom = (i32)G_WorkAreaH - G_SelectionEnd.y;
-
-                    std::string ResultMessage =
-                        "Left:\t  " + std::to_string(Left) +
-                        "\nTop:\t  " + std::to_string(Top) +
-                        "\nRight:\t  " + std::to_string(Right) +
-                        "\nBottom:\t  " + std::to_string(Bottom) +
-                        "                                          "; // NOTE: Widen the box a little
-
-                    // NOTE: Make the window invisible
-                    SetLayeredWindowAttributes(Window, RGB(0, 0, 0), 0, LWA_ALPHA);
-
-                    // NOTE: Show the data to the user
-                    // TODO: Find a way to make this wider?
-                    MessageBox(Window, ResultMessage.c_str(), "PCG Cam Utility Results", MB_OK | MB_TOPMOST);
-
-                    // NOTE: Close the app
-                    G_Running = false;
+                    variant::Instrumentation::Log("Selection is valid\n");
+
+                    ShowSelectionResult<variant>(Window);
                 }
                 else
                 {
-                    #if PCG_INTERNAL
-                    OutputDebugStringA("Selection is invalid\n");
-                    #endif
+                    variant::Instrumentation::Log("Selection is invalid\n");
                     G_HasDrawnSelection = false;
                     G_SelectionStart = { };
                     G_SelectionEnd = { };
@@ -614,7 +1195,7 @@ LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam
         break;
         case WM_MOUSELEAVE:
         {
-            UpdateWindowPosition(Window);
+            UpdateWindowPosition<variant>(Window);
 
             // NOTE: We need to start tracking the mouse again-- apparently this is a one-shot deal
             TrackingMouse = false;
@@ -637,7 +1218,11 @@ LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam
 
             if (G_IsDrawingSelection)
             {
-                UpdateSelection(Window);
+                UpdateSelection<variant>(Window);
+            }
+            else if (G_IsPickingWindow)
+            {
+                UpdateHoveredWindow<variant>(Window);
             }
         }
         break;
@@ -649,35 +1234,12 @@ LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam
             RECT ClientRect;
             GetClientRect(Window, &ClientRect);
 
-            // NOTE: Thanks to https://stackoverflow.com/a/51330038/11878570 for this solution (removes the flickering with GDI+)
-            HDC MemDC;
-            HPAINTBUFFER Buffer = BeginBufferedPaint(DeviceContext, &ClientRect, BPBF_COMPATIBLEBITMAP, NULL, &MemDC);
-
-            // NOTE: Draw the translucent window background
-            localpersist HBRUSH WindowBGBrush = CreateSolidBrush(RGB(20, 20, 20));
-            FillRect(MemDC, &ClientRect, WindowBGBrush);
-
             if (G_IsDrawingSelection)
             {
-                // NOTE: Draw the selection rectangle outline
-                rect2i Start;
-                Start.X = Min(G_SelectionStart.x, G_SelectionEnd.x);
-                Start.Y = Min(G_SelectionStart.y, G_SelectionEnd.y);
-
-                rect2i End;
-                End.X = Max(G_SelectionStart.x, G_SelectionEnd.x);
-                End.Y = Max(G_SelectionStart.y, G_SelectionEnd.y);
-
-                PaintSelection(MemDC, Start, End);
-            }
-            else
-            {
-                rect2i Start = { };
-                rect2i End = { };
-                PaintSelection(MemDC, Start, End);
+                PredictSelectionEnd<variant>(Window);
             }
 
-            EndBufferedPaint(Buffer, TRUE);
+            PaintFrame<variant>(DeviceContext, ClientRect);
 
             EndPaint(Window, &PaintStruct);
         }
@@ -692,11 +1254,153 @@ LRESULT CALLBACK PcgCamUtilityProcedure(HWND Window, UINT Message, WPARAM WParam
     return(Result);
 }
 
-i32 WinMain(HINSTANCE Instance, [[maybe_unused]] HINSTANCE PrevInstance, [[maybe_unused]] LPSTR CommandLine, [[maybe_unused]] int ShowCommand)
+#if PCG_BENCHMARK
+/// Times a simulated drag (selection updates and full frame paints) for one variant, painting off-screen.
+/// NOTE: No messages are pumped, so this times the work per frame, not how often frames are painted
+/// (which is all the pacing policy decides)
+template <typename variant>
+internal void BenchmarkVariant(HWND Window, std::string *Results)
+{
+    const i32 FrameCount = 600;
+
+    RECT ClientRect = { 0, 0, (LONG)G_WorkAreaW, (LONG)G_WorkAreaH };
+    HDC WindowDC = GetDC(Window);
+    HDC TargetDC = CreateCompatibleDC(WindowDC);
+    HBITMAP TargetBitmap = CreateCompatibleBitmap(WindowDC, ClientRect.right, ClientRect.bottom);
+    HGDIOBJ PreviousBitmap = SelectObject(TargetDC, TargetBitmap);
+    ReleaseDC(Window, WindowDC);
+
+    UpdateMonitorStats<variant>(Window);
+
+    G_IsDrawingSelection = true;
+    G_SelectionStart = { ClientRect.right / 8, ClientRect.bottom / 8 };
+    G_SelectionEnd = G_SelectionStart;
+
+    LARGE_INTEGER Frequency;
+    LARGE_INTEGER StartCounter;
+    LARGE_INTEGER EndCounter;
+    QueryPerformanceFrequency(&Frequency);
+    QueryPerformanceCounter(&StartCounter);
+
+    for (i32 Frame = 0; Frame < FrameCount; ++Frame)
+    {
+        // NOTE: Drag the corner out towards the bottom-right of the screen and back again
+        i32 Step = Frame % 200;
+        i32 Progress = (Step < 100) ? Step : 200 - Step;
+        POINT End;
+        End.x = G_SelectionStart.x + ((ClientRect.right * 3 / 4) * Progress) / 100;
+        End.y = G_SelectionStart.y + ((ClientRect.bottom * 3 / 4) * Progress) / 100;
+
+        SetSelectionEnd<variant>(Window, End);
+        PaintFrame<variant>(TargetDC, ClientRect);
+    }
+
+    GdiFlush();
+    QueryPerformanceCounter(&EndCounter);
+
+    r64 MillisecondsPerFrame = (1000.0 * (r64)(EndCounter.QuadPart - StartCounter.QuadPart)) /
+                               ((r64)Frequency.QuadPart * (r64)FrameCount);
+
+    char Line[256];
+    snprintf(Line, sizeof(Line), "%-16s %-10s %-12s %8.3f ms/frame\r\n",
+             variant::Instrumentation::Name, variant::RenderBackend::Name, variant::DebugOverlay::Name, MillisecondsPerFrame);
+    *Results += Line;
+
+    KillTimer(Window, FrameTimerId);
+    G_IsDrawingSelection = false;
+    G_SelectionStart = { };
+    G_SelectionEnd = { };
+
+    SelectObject(TargetDC, PreviousBitmap);
+    DeleteObject(TargetBitmap);
+    DeleteDC(TargetDC);
+}
+
+/// Instantiates and benchmarks one variant per bit pattern (bit 0: instrumentation, 1: render backend, 2: debug overlay).
+/// NOTE: Pacing is left out (see BenchmarkVariant), every variant uses the refresh timer
+template <u32... VariantBits>
+internal void BenchmarkVariants(HWND Window, std::string *Results, std::integer_sequence<u32, VariantBits...>)
 {
+    (BenchmarkVariant<pcg_variant_from_flags<(VariantBits & 1), 1, (VariantBits & 2), (VariantBits & 4)>>(Window, Results), ...);
+}
+
+/// Benchmarks the variants (every combination but the pacing), and writes the results to variants_bench.txt
+/// in the working directory.
+internal void RunVariantBenchmarks(HWND Window)
+{
+    std::string Results = "instrumentation  render     overlay        frame time\r\n";
+    BenchmarkVariants(Window, &Results, std::make_integer_sequence<u32, VariantCount / 2>());
+
+    HANDLE File = CreateFileA("variants_bench.txt", GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (File != INVALID_HANDLE_VALUE)
+    {
+        DWORD BytesWritten;
+        WriteFile(File, Results.c_str(), (DWORD)Results.size(), &BytesWritten, NULL);
+        CloseHandle(File);
+    }
+    else
+    {
+        OutputDebugStringA("Failed to write variants_bench.txt!\n");
+    }
+}
+#endif
+
+/// Opts out of DPI virtualization, so the cursor, the work area and the window bounds (DWM always reports
+/// those in physical pixels) all share the same coordinates on scaled displays.
+internal void MakeProcessDpiAware()
+{
+    // NOTE: Per-monitor awareness needs Windows 10 1703, so it's looked up at runtime instead of linked
+    typedef BOOL WINAPI set_process_dpi_awareness_context(DPI_AWARENESS_CONTEXT Context);
+    set_process_dpi_awareness_context *SetProcessDpiAwarenessContextFunction =
+        (set_process_dpi_awareness_context *)(void *)GetProcAddress(GetModuleHandleA("user32.dll"), "SetProcessDpiAwarenessContext");
+    if (!SetProcessDpiAwarenessContextFunction ||
+        !SetProcessDpiAwarenessContextFunction(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
+    {
+        // NOTE: System awareness is correct on the primary monitor at least
+        SetProcessDPIAware();
+    }
+}
+
+i32 WinMain(HINSTANCE Instance, [[maybe_unused]] HINSTANCE PrevInstance, LPSTR CommandLine, [[maybe_unused]] int ShowCommand)
+{
+    // NOTE: Must happen before any windows are created
+    MakeProcessDpiAware();
+
+    LARGE_INTEGER PerformanceFrequency;
+    QueryPerformanceFrequency(&PerformanceFrequency);
+    G_PerformanceFrequency = (r64)PerformanceFrequency.QuadPart;
+
+    // NOTE: Cursor prediction while dragging (-predict:none, -predict:linear or -predict:kalman)
+    G_CursorPredictor.Config = DefaultCursorPredictorConfig();
+    if (strstr(CommandLine, "-predict:none"))
+    {
+        G_CursorPredictor.Config.Mode = CursorPrediction_None;
+    }
+    else if (strstr(CommandLine, "-predict:linear"))
+    {
+        G_CursorPredictor.Config.Mode = CursorPrediction_Linear;
+    }
+    else if (strstr(CommandLine, "-predict:kalman"))
+    {
+        G_CursorPredictor.Config.Mode = CursorPrediction_Kalman;
+    }
+
+    // NOTE: Report offsets on an OBS canvas of a different size to the monitor (e.g. -canvas:1920x1080)
+    if (const char *CanvasOption = strstr(CommandLine, "-canvas:"))
+    {
+        char *SizeEnd;
+        G_CanvasW = (i32)strtol(CanvasOption + 8, &SizeEnd, 10);
+        G_CanvasH = (*SizeEnd == 'x' || *SizeEnd == 'X') ? (i32)strtol(SizeEnd + 1, NULL, 10) : 0;
+        if (G_CanvasW <= 0 || G_CanvasH <= 0)
+        {
+            G_CanvasW = 0;
+            G_CanvasH = 0;
+        }
+    }
+
     // NOTE: Register the window class
     WNDCLASSA WindowClass = { };
-    WindowClass.lpfnWndProc = PcgCamUtilityProcedure;
+    WindowClass.lpfnWndProc = PcgCamUtilityProcedure<pcg_build_variant>;
     WindowClass.hInstance = Instance;
     WindowClass.hCursor = LoadCursor(0, IDC_CROSS);
     WindowClass.lpszClassName = "PcgCameraUtility";
@@ -721,6 +1425,7 @@ i32 WinMain(HINSTANCE Instance, [[maybe_unused]] HINSTANCE PrevInstance, [[maybe
         OutputDebugStringA("Failed to create the window!\n");
         return 1;
     }
+    G_OverlayWindow = Window;
 
     // NOTE: Initialize GDI+
     Gdiplus::GdiplusStartupInput GdiPlusStartupInput;
@@ -732,8 +1437,18 @@ i32 WinMain(HINSTANCE Instance, [[maybe_unused]] HINSTANCE PrevInstance, [[maybe
     ToggleWindowFullScreen(Window);
 
     // NOTE: Get monitor info
-    UpdateMonitorStats(Window);
-
+    UpdateMonitorStats<pcg_build_variant>(Window);
+
+    // NOTE: Snapshot the windows for the window picker, and keep the snapshot up to date from window events
+    SnapshotTopLevelWindows();
+    G_WindowEventHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_OBJECT_UNCLOAKED, NULL, WindowEventCallback,
+                                        0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+
+    #if PCG_BENCHMARK
+    // NOTE: Benchmark builds time every variant off-screen instead of running the program
+    ShowWindow(Window, SW_HIDE);
+    RunVariantBenchmarks(Window);
+    #else
     // NOTE: Program loop
     G_Running = true;
     MSG Message;
@@ -747,6 +1462,12 @@ i32 WinMain(HINSTANCE Instance, [[maybe_unused]] HINSTANCE PrevInstance, [[maybe
         TranslateMessage(&Message);
         DispatchMessageA(&Message);
     }
+    #endif
+
+    if (G_WindowEventHook)
+    {
+        UnhookWinEvent(G_WindowEventHook);
+    }
 
     // NOTE: Shut down GDI+
     Gdiplus::GdiplusShutdown(GdiPlusToken);
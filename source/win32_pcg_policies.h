@@ -0,0 +1,166 @@
+#if !defined(WIN32_PCG_POLICIES_H)
+#define WIN32_PCG_POLICIES_H
+/*
+    ==========================================================================
+    File: win32_pcg_policies.h
+    Date: 18/10/2026
+    ==========================================================================
+
+    Policies for the build variants. Each variant is a combination of an instrumentation,
+    pacing, render backend and debug overlay policy, and the code that used to be switched
+    with #if blocks is templated on the variant instead. Everything is resolved at compile
+    time, so a release build carries none of the instrumentation, and every combination
+    stays compiled (see the -variants target in tools/build.bat).
+
+    The PCG_* build flags only pick which variant the program runs with.
+*/
+
+#include <type_traits>
+
+/// The ID of the timer that drives repaints with the refresh-timer pacing policy.
+const UINT_PTR FrameTimerId = 999;
+
+//
+// NOTE: Instrumentation policies
+//
+
+/// Compiles all diagnostics out.
+struct instrumentation_none
+{
+    static constexpr b32 Enabled = false;
+    static constexpr const char *Name = "none";
+
+    static void Log([[maybe_unused]] const char *Message) { }
+};
+
+/// Writes diagnostics to the debugger output.
+struct instrumentation_debug_output
+{
+    static constexpr b32 Enabled = true;
+    static constexpr const char *Name = "debug-output";
+
+    static void Log(const char *Message)
+    {
+        OutputDebugStringA(Message);
+    }
+};
+
+//
+// NOTE: Pacing policies
+//
+
+/// Repaints on a timer at the monitor's refresh rate.
+/// NOTE: This is not *ACTUALLY* V-Sync, only an approximation!
+struct pacing_refresh_timer
+{
+    static constexpr b32 RepaintOnChange = false;
+    static constexpr b32 PredictsCursor = true;
+    static constexpr const char *Name = "refresh-timer";
+
+    /// Starts (or restarts) the repaint timer.
+    static void StartFrameTimer(HWND Window, i32 MonitorRefreshHz)
+    {
+        SetTimer(Window, FrameTimerId, 1000 / MonitorRefreshHz, NULL);
+    }
+};
+
+/// Repaints as soon as the selection changes.
+struct pacing_immediate
+{
+    static constexpr b32 RepaintOnChange = true;
+    static constexpr b32 PredictsCursor = false; // NOTE: Nothing would repaint a predicted corner once the cursor stops
+    static constexpr const char *Name = "immediate";
+
+    static void StartFrameTimer([[maybe_unused]] HWND Window, [[maybe_unused]] i32 MonitorRefreshHz) { }
+};
+
+//
+// NOTE: Render backend policies
+//
+
+/// Paints into an off-screen buffer first, which removes the flickering with GDI+.
+/// NOTE: Thanks to https://stackoverflow.com/a/51330038/11878570 for this solution
+struct render_buffered
+{
+    static constexpr const char *Name = "buffered";
+
+    struct frame
+    {
+        HPAINTBUFFER Buffer;
+        HDC DeviceContext;
+    };
+
+    static frame BeginFrame(HDC TargetDC, const RECT *ClientRect)
+    {
+        frame Frame = { };
+        Frame.Buffer = BeginBufferedPaint(TargetDC, ClientRect, BPBF_COMPATIBLEBITMAP, NULL, &Frame.DeviceContext);
+        return Frame;
+    }
+
+    static void EndFrame(frame *Frame)
+    {
+        EndBufferedPaint(Frame->Buffer, TRUE);
+    }
+};
+
+/// Paints straight into the target (flickers, but useful for comparing against the buffered backend).
+struct render_direct
+{
+    static constexpr const char *Name = "direct";
+
+    struct frame
+    {
+        HDC DeviceContext;
+    };
+
+    static frame BeginFrame(HDC TargetDC, [[maybe_unused]] const RECT *ClientRect)
+    {
+        frame Frame = { TargetDC };
+        return Frame;
+    }
+
+    static void EndFrame([[maybe_unused]] frame *Frame) { }
+};
+
+//
+// NOTE: Debug overlay policies
+//
+
+struct debug_overlay_none
+{
+    static constexpr b32 ShowSelectionCoordinates = false;
+    static constexpr const char *Name = "none";
+};
+
+/// Draws the raw start/end coordinates next to the selection corners.
+struct debug_overlay_coordinates
+{
+    static constexpr b32 ShowSelectionCoordinates = true;
+    static constexpr const char *Name = "coordinates";
+};
+
+//
+// NOTE: Variants
+//
+
+template <typename instrumentation, typename pacing, typename render_backend, typename debug_overlay>
+struct pcg_variant
+{
+    typedef instrumentation Instrumentation;
+    typedef pacing Pacing;
+    typedef render_backend RenderBackend;
+    typedef debug_overlay DebugOverlay;
+};
+
+/// Maps the PCG_* build flags onto a variant.
+template <b32 Internal, b32 AttemptVSync, b32 BufferedPaint, b32 DebugOverlay>
+using pcg_variant_from_flags = pcg_variant<
+    std::conditional_t<(Internal != 0), instrumentation_debug_output, instrumentation_none>,
+    std::conditional_t<(AttemptVSync != 0), pacing_refresh_timer, pacing_immediate>,
+    std::conditional_t<(BufferedPaint != 0), render_buffered, render_direct>,
+    std::conditional_t<(DebugOverlay != 0), debug_overlay_coordinates, debug_overlay_none>>;
+
+/// The number of distinct variants (one bit per policy).
+const u32 VariantCount = 16;
+
+#endif
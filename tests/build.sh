@@ -0,0 +1,41 @@
+#!/bin/sh
+#
+#   Builds and runs the tests for the platform-independent headers (the ones that don't include
+#   Windows.h) on Linux, from the tests directory:
+#
+#       ./build.sh -test     Builds with the address/undefined behaviour sanitizers and runs the tests
+#       ./build.sh -bench    Builds with optimizations only and runs the tests and benchmarks, for timings
+#
+#   The programs are built to ../build/tests/ and need the zlib development files. Set CXX to use a
+#   compiler other than g++.
+#
+
+set -e
+
+CXX=${CXX:-g++}
+CommonFlags="-std=c++17 -g -Wall -Wextra -Werror -Wno-unused-function -pthread -I../source"
+Libraries="-lz" # NOTE: zlib decodes the PNGs in png_test
+Tests="window_index_test png_test cursor_replay canvas_map_test"
+Benchmarks="png_bench"
+
+case "$1" in
+    -test|"")
+        Flags="$CommonFlags -O1 -fsanitize=address,undefined -fno-sanitize-recover=all"
+        Programs="$Tests"
+        ;;
+    -bench)
+        Flags="$CommonFlags -O2 -march=native"
+        Programs="$Tests $Benchmarks"
+        ;;
+    *)
+        echo "Usage: ./build.sh -[test/bench]"
+        exit 1
+        ;;
+esac
+
+mkdir -p ../build/tests
+for Program in $Programs; do
+    echo "== $Program"
+    $CXX $Flags $Program.cpp -o ../build/tests/$Program $Libraries
+    ../build/tests/$Program
+done
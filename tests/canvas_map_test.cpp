@@ -0,0 +1,195 @@
+/*
+    ==========================================================================
+    File: canvas_map_test.cpp
+    Date: 18/10/2026
+    ==========================================================================
+
+    Checks every edge of every pairing of common monitor and canvas sizes against the exact
+    rounding rule, and checks that batches of rectangles map the same way, then times the batch
+    mapping and the table build. Built and run by tests/build.sh.
+*/
+
+#include "pcg_canvas_map.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+
+/// Common monitor resolutions, and work areas with a 40 px taskbar taken off.
+const i32 TestSizes[][2] =
+{
+    { 1280, 720 }, { 1366, 768 }, { 1600, 900 }, { 1920, 1080 }, { 1920, 1200 },
+    { 2560, 1080 }, { 2560, 1440 }, { 2560, 1600 }, { 3440, 1440 }, { 3840, 2160 },
+    { 5120, 2880 }, { 7680, 4320 }, { 1920, 1040 }, { 2560, 1400 }, { 3840, 2120 },
+};
+const u32 TestSizeCount = sizeof(TestSizes) / sizeof(TestSizes[0]);
+
+/// Checks one axis of a map: every edge is the nearest canvas pixel (halves round up), the ends land on
+/// the canvas ends, and the mapping never goes backwards.
+internal u64 TestCanvasAxis(const std::vector<i32> &Table, i32 MonitorSize, i32 CanvasSize, u64 *EdgeCount)
+{
+    u64 Mismatches = 0;
+    if (Table.size() != (size_t)MonitorSize + 1)
+    {
+        return 1;
+    }
+
+    i32 PreviousValue = 0;
+    for (i32 Edge = 0; Edge <= MonitorSize; ++Edge)
+    {
+        // NOTE: Value is the nearest integer to Edge * CanvasSize / MonitorSize, halves up, exactly when
+        // 2 * Value * MonitorSize <= 2 * Edge * CanvasSize + MonitorSize < 2 * (Value + 1) * MonitorSize
+        i64 Value = Table[Edge];
+        i64 Scaled = 2 * (i64)Edge * CanvasSize + MonitorSize;
+        b32 Matches = (2 * Value * MonitorSize <= Scaled && Scaled < 2 * (Value + 1) * MonitorSize &&
+                       Value >= PreviousValue && Value == MapEdgeToCanvas(Edge, MonitorSize, CanvasSize));
+        if ((Edge == 0 && Value != 0) || (Edge == MonitorSize && Value != CanvasSize) || !Matches)
+        {
+            ++Mismatches;
+        }
+        PreviousValue = (i32)Value;
+        ++*EdgeCount;
+    }
+
+    return Mismatches;
+}
+
+/// Maps random rectangles (including ones hanging off the monitor) in a batch, and checks each edge
+/// against the clamped single-edge mapping.
+internal u64 TestCanvasRects(const canvas_map *Map, std::mt19937 *Random)
+{
+    const u32 RectCount = 20000;
+    std::vector<canvas_rect> Rects(RectCount);
+    std::vector<canvas_rect> CanvasRects(RectCount);
+    for (u32 RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+    {
+        canvas_rect *Rect = &Rects[RectIndex];
+        Rect->Left = (i32)((*Random)() % (u32)(Map->MonitorW + 200)) - 100;
+        Rect->Top = (i32)((*Random)() % (u32)(Map->MonitorH + 200)) - 100;
+        Rect->Right = Rect->Left + (i32)((*Random)() % (u32)Map->MonitorW);
+        Rect->Bottom = Rect->Top + (i32)((*Random)() % (u32)Map->MonitorH);
+    }
+    MapRectsToCanvas(Map, Rects.data(), CanvasRects.data(), RectCount);
+
+    u64 Mismatches = 0;
+    for (u32 RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+    {
+        const canvas_rect *Rect = &Rects[RectIndex];
+        const canvas_rect *CanvasRect = &CanvasRects[RectIndex];
+        if (CanvasRect->Left != MapEdgeToCanvas(Min(Max(Rect->Left, 0), Map->MonitorW), Map->MonitorW, Map->CanvasW) ||
+            CanvasRect->Top != MapEdgeToCanvas(Min(Max(Rect->Top, 0), Map->MonitorH), Map->MonitorH, Map->CanvasH) ||
+            CanvasRect->Right != MapEdgeToCanvas(Min(Max(Rect->Right, 0), Map->MonitorW), Map->MonitorW, Map->CanvasW) ||
+            CanvasRect->Bottom != MapEdgeToCanvas(Min(Max(Rect->Bottom, 0), Map->MonitorH), Map->MonitorH, Map->CanvasH) ||
+            CanvasRect->Left > CanvasRect->Right || CanvasRect->Top > CanvasRect->Bottom)
+        {
+            ++Mismatches;
+        }
+    }
+
+    // NOTE: Mapping in place has to give the same result
+    MapRectsToCanvas(Map, Rects.data(), Rects.data(), RectCount);
+    for (u32 RectIndex = 0; RectIndex < RectCount; ++RectIndex)
+    {
+        if (memcmp(&Rects[RectIndex], &CanvasRects[RectIndex], sizeof(canvas_rect)) != 0)
+        {
+            ++Mismatches;
+        }
+    }
+
+    return Mismatches;
+}
+
+/// Checks that a canvas size of 0 (or a canvas the size of the monitor) maps every edge onto itself.
+internal u64 TestIdentity()
+{
+    u64 Mismatches = 0;
+    canvas_map Unscaled = { };
+    BuildCanvasMap(&Unscaled, 2560, 1440, 0, 0);
+    canvas_map SameSize = { };
+    BuildCanvasMap(&SameSize, 2560, 1440, 2560, 1440);
+    if (IsCanvasMapScaled(&Unscaled) || IsCanvasMapScaled(&SameSize))
+    {
+        ++Mismatches;
+    }
+    for (i32 Edge = 0; Edge <= 2560; ++Edge)
+    {
+        if (Unscaled.CanvasX[Edge] != Edge || SameSize.CanvasX[Edge] != Edge)
+        {
+            ++Mismatches;
+        }
+    }
+
+    // NOTE: A zero-sized work area (e.g. before the monitor info has been read) still gives a usable map
+    canvas_map Empty = { };
+    BuildCanvasMap(&Empty, 0, 0, 1920, 1080);
+    canvas_rect Rect = { -5, -5, 10, 10 };
+    MapRectsToCanvas(&Empty, &Rect, &Rect, 1);
+    if (Rect.Left != 0 || Rect.Top != 0 || Rect.Right != 1920 || Rect.Bottom != 1080)
+    {
+        ++Mismatches;
+    }
+
+    return Mismatches;
+}
+
+internal void TimeCanvasMap()
+{
+    canvas_map Map = { };
+    BuildCanvasMap(&Map, 2560, 1440, 1920, 1080);
+
+    std::mt19937 Random(1);
+    std::vector<canvas_rect> Rects(1 << 22);
+    for (canvas_rect &Rect : Rects)
+    {
+        Rect = { (i32)(Random() % 2561), (i32)(Random() % 1441), (i32)(Random() % 2561), (i32)(Random() % 1441) };
+    }
+
+    std::chrono::steady_clock::time_point MapStart = std::chrono::steady_clock::now();
+    MapRectsToCanvas(&Map, Rects.data(), Rects.data(), (u32)Rects.size());
+    std::chrono::steady_clock::time_point MapEnd = std::chrono::steady_clock::now();
+
+    canvas_map Large = { };
+    BuildCanvasMap(&Large, 7680, 4320, 1920, 1080);
+    std::chrono::steady_clock::time_point BuildEnd = std::chrono::steady_clock::now();
+
+    i64 Checksum = 0;
+    for (const canvas_rect &Rect : Rects)
+    {
+        Checksum += Rect.Left + Rect.Right;
+    }
+    printf("Batch: %.2f ns per rect (checksum %lld), 8K tables built in %.1f us\n",
+           std::chrono::duration<r64, std::nano>(MapEnd - MapStart).count() / (r64)Rects.size(), (long long)Checksum,
+           std::chrono::duration<r64, std::micro>(BuildEnd - MapEnd).count());
+}
+
+int main()
+{
+    u64 EdgeCount = 0;
+    u64 EdgeMismatches = 0;
+    u64 RectMismatches = 0;
+    for (u32 MonitorIndex = 0; MonitorIndex < TestSizeCount; ++MonitorIndex)
+    {
+        for (u32 CanvasIndex = 0; CanvasIndex < TestSizeCount; ++CanvasIndex)
+        {
+            const i32 *Monitor = TestSizes[MonitorIndex];
+            const i32 *Canvas = TestSizes[CanvasIndex];
+            canvas_map Map = { };
+            BuildCanvasMap(&Map, Monitor[0], Monitor[1], Canvas[0], Canvas[1]);
+            EdgeMismatches += TestCanvasAxis(Map.CanvasX, Monitor[0], Canvas[0], &EdgeCount);
+            EdgeMismatches += TestCanvasAxis(Map.CanvasY, Monitor[1], Canvas[1], &EdgeCount);
+
+            std::mt19937 Random(MonitorIndex * TestSizeCount + CanvasIndex);
+            RectMismatches += TestCanvasRects(&Map, &Random);
+        }
+    }
+    printf("Edges: %u monitor/canvas pairs, %llu edges, %llu mismatches\n", TestSizeCount * TestSizeCount,
+           (unsigned long long)EdgeCount, (unsigned long long)EdgeMismatches);
+    printf("Rects: %llu mismatches\n", (unsigned long long)RectMismatches);
+
+    u64 IdentityMismatches = TestIdentity();
+    printf("Identity: %llu mismatches\n", (unsigned long long)IdentityMismatches);
+
+    TimeCanvasMap();
+
+    return (EdgeMismatches || RectMismatches || IdentityMismatches) ? 1 : 0;
+}
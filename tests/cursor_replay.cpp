@@ -0,0 +1,287 @@
+/*
+    ==========================================================================
+    File: cursor_replay.cpp
+    Date: 18/10/2026
+    ==========================================================================
+
+    Replays cursor traces through the cursor predictor the way the overlay drives it while
+    dragging, and measures how far the drawn selection corner is from the hardware cursor when
+    each frame is shown. Built and run by tests/build.sh.
+
+    The overlay samples the cursor on every WM_MOUSEMOVE and again at every paint, and predicts
+    one refresh ahead. The hardware cursor shows the latest mouse report, so that's what the
+    prediction is compared against.
+
+    With no arguments, synthetic traces are used: minimum-jerk strokes between random points,
+    with random pauses, reported at 125 Hz and 1000 Hz. A third of the strokes halt abruptly
+    halfway, at full speed, which is the worst case for overshooting. Recorded traces can be replayed by
+    passing their paths; each line is "<time in seconds> <x> <y>", one line per mouse report.
+
+    Fails if any prediction mode has a larger mean error than not predicting while the cursor
+    moves, or if any frame painted after the cursor has been still for the predictor's stop time
+    isn't exactly on the cursor. The frames shown just after a stop are reported, but not checked:
+    a frame painted while the cursor still moves can't know that it's about to stop, so predicting
+    overshoots there, where not predicting lags.
+*/
+
+#include "pcg_cursor_predictor.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+struct cursor_report
+{
+    r64 Time;
+    i32 X;
+    i32 Y;
+};
+
+struct cursor_trace
+{
+    std::string Name;
+    std::vector<cursor_report> Reports; // NOTE: Sorted by time
+};
+
+struct replay_errors
+{
+    std::vector<r64> Moving;    // NOTE: Frames shown while the cursor moves
+    std::vector<r64> AfterStop; // NOTE: Frames shown in the first 100 ms after the cursor stops
+    u32 LateOvershoots;         // NOTE: Frames off the cursor, although it was still for the stop time when they were painted
+    r64 NanosecondsPerFrame;
+};
+
+/// Where the cursor is along a list of strokes at the given time.
+internal void GetStrokePosition(const std::vector<r64> &Strokes, r64 Time, r64 *X, r64 *Y)
+{
+    // NOTE: Each stroke is (start time, end time, from x, from y, to x, to y, fraction of the stroke
+    // after which it halts)
+    *X = Strokes[2];
+    *Y = Strokes[3];
+    for (size_t Stroke = 0; Stroke < Strokes.size(); Stroke += 7)
+    {
+        const r64 *S = &Strokes[Stroke];
+        if (Time < S[0])
+        {
+            break;
+        }
+
+        // NOTE: Minimum-jerk profile, which is close to how people move a mouse between two targets
+        r64 U = Min((Time - S[0]) / (S[1] - S[0]), S[6]);
+        r64 K = U * U * U * (10.0 - 15.0 * U + 6.0 * U * U);
+        *X = S[2] + (S[4] - S[2]) * K;
+        *Y = S[3] + (S[5] - S[3]) * K;
+    }
+}
+
+internal cursor_trace MakeSyntheticTrace(r64 ReportHz, u32 Seed)
+{
+    std::mt19937 Random(Seed);
+    std::uniform_real_distribution<r64> Unit(0.0, 1.0);
+
+    std::vector<r64> Strokes;
+    r64 Time = 0.0;
+    r64 X = 500.0;
+    r64 Y = 500.0;
+    for (u32 StrokeIndex = 0; StrokeIndex < 400; ++StrokeIndex)
+    {
+        r64 ToX = 100.0 + Unit(Random) * 2300.0;
+        r64 ToY = 100.0 + Unit(Random) * 1200.0;
+        r64 Distance = sqrt((ToX - X) * (ToX - X) + (ToY - Y) * (ToY - Y));
+        r64 Duration = 0.15 + Distance / 3000.0 * (0.5 + Unit(Random));
+        r64 Halt = (Unit(Random) < 1.0 / 3.0) ? 0.5 : 1.0;
+        r64 Stroke[7] = { Time, Time + Duration, X, Y, ToX, ToY, Halt };
+        Strokes.insert(Strokes.end(), Stroke, Stroke + 7);
+
+        Time += Duration * Halt + ((Unit(Random) < 0.5) ? Unit(Random) * 0.3 : 0.0);
+        GetStrokePosition(Strokes, Time, &X, &Y);
+    }
+
+    // NOTE: Mice only report when they've moved
+    cursor_trace Trace;
+    Trace.Name = "synthetic " + std::to_string((i32)ReportHz) + " Hz";
+    for (u32 Report = 0; Report / ReportHz < Time; ++Report)
+    {
+        r64 ReportTime = Report / ReportHz;
+        GetStrokePosition(Strokes, ReportTime, &X, &Y);
+        cursor_report Sample = { ReportTime, (i32)floor(X + 0.5), (i32)floor(Y + 0.5) };
+        if (Trace.Reports.empty() || Trace.Reports.back().X != Sample.X || Trace.Reports.back().Y != Sample.Y)
+        {
+            Trace.Reports.push_back(Sample);
+        }
+    }
+
+    return Trace;
+}
+
+internal b32 LoadTrace(const char *Path, cursor_trace *Trace)
+{
+    FILE *File = fopen(Path, "r");
+    if (!File)
+    {
+        return false;
+    }
+
+    Trace->Name = Path;
+    cursor_report Report;
+    while (fscanf(File, "%lf %d %d", &Report.Time, &Report.X, &Report.Y) == 3)
+    {
+        Trace->Reports.push_back(Report);
+    }
+    fclose(File);
+
+    std::stable_sort(Trace->Reports.begin(), Trace->Reports.end(),
+                     [](const cursor_report &A, const cursor_report &B) { return A.Time < B.Time; });
+    return Trace->Reports.size() >= 2;
+}
+
+/// Replays a trace at the given refresh rate, painting a frame on every refresh.
+internal replay_errors ReplayTrace(const cursor_trace *Trace, cursor_prediction_mode Mode, r64 RefreshHz)
+{
+    replay_errors Errors = { };
+    cursor_predictor Predictor = { };
+    Predictor.Config = DefaultCursorPredictorConfig();
+    Predictor.Config.Mode = Mode;
+
+    const std::vector<cursor_report> &Reports = Trace->Reports;
+    r64 FrameTime = 1.0 / RefreshHz;
+    size_t NextReport = 0;
+    size_t ShownReport = 0;
+    r64 PredictorSeconds = 0.0;
+    u32 FrameCount = 0;
+    for (r64 Now = Reports.front().Time; Now + FrameTime <= Reports.back().Time; Now += FrameTime)
+    {
+        std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+        // NOTE: The WM_MOUSEMOVE samples since the last frame
+        for (; NextReport < Reports.size() && Reports[NextReport].Time <= Now; ++NextReport)
+        {
+            AddCursorSample(&Predictor, Reports[NextReport].Time, Reports[NextReport].X, Reports[NextReport].Y);
+        }
+        const cursor_report *Current = &Reports[NextReport - 1];
+
+        // NOTE: The paint sample, then the prediction for when the frame is shown
+        AddCursorSample(&Predictor, Now, Current->X, Current->Y);
+        i32 X = 0;
+        i32 Y = 0;
+        PredictCursor(&Predictor, Now + FrameTime, &X, &Y);
+
+        PredictorSeconds += std::chrono::duration<r64>(std::chrono::steady_clock::now() - Start).count();
+        ++FrameCount;
+
+        while (ShownReport + 1 < Reports.size() && Reports[ShownReport + 1].Time <= Now + FrameTime)
+        {
+            ++ShownReport;
+        }
+        const cursor_report *Shown = &Reports[ShownReport];
+        r64 Error = sqrt((r64)((X - Shown->X) * (X - Shown->X) + (Y - Shown->Y) * (Y - Shown->Y)));
+
+        // NOTE: Anything longer than a couple of reports without a new one counts as stopped
+        b32 IsMoving = (ShownReport + 1 < Reports.size() && Reports[ShownReport + 1].Time - Shown->Time < 0.02);
+        if (IsMoving)
+        {
+            Errors.Moving.push_back(Error);
+        }
+        else if (Now + FrameTime - Shown->Time < 0.1)
+        {
+            Errors.AfterStop.push_back(Error);
+        }
+
+        if (!IsMoving && Now - Shown->Time >= Predictor.Config.StopSeconds && Error > 0.0)
+        {
+            ++Errors.LateOvershoots;
+        }
+    }
+
+    Errors.NanosecondsPerFrame = 1.0e9 * PredictorSeconds / Max(FrameCount, 1u);
+    return Errors;
+}
+
+internal r64 GetMean(const std::vector<r64> &Values)
+{
+    r64 Sum = 0.0;
+    for (r64 Value : Values)
+    {
+        Sum += Value;
+    }
+    return Values.empty() ? 0.0 : Sum / (r64)Values.size();
+}
+
+internal r64 GetPercentile(std::vector<r64> Values, u32 Percent)
+{
+    if (Values.empty())
+    {
+        return 0.0;
+    }
+    std::sort(Values.begin(), Values.end());
+    return Values[Min((size_t)Values.size() * Percent / 100, Values.size() - 1)];
+}
+
+/// Replays the trace with every prediction mode, returning false if prediction made anything worse.
+internal b32 ReportTrace(const cursor_trace *Trace)
+{
+    const cursor_prediction_mode Modes[] = { CursorPrediction_None, CursorPrediction_Linear, CursorPrediction_Kalman };
+    const char *ModeNames[] = { "none", "linear", "kalman" };
+
+    printf("%s (%zu reports, %.1f s), 60 Hz refresh\n", Trace->Name.c_str(), Trace->Reports.size(),
+           Trace->Reports.back().Time - Trace->Reports.front().Time);
+    printf("    mode      moving: mean    p95    max   after stop: mean    max   late overshoots   predictor\n");
+
+    b32 Passed = true;
+    r64 UnpredictedMoving = 0.0;
+    for (u32 ModeIndex = 0; ModeIndex < sizeof(Modes) / sizeof(Modes[0]); ++ModeIndex)
+    {
+        replay_errors Errors = ReplayTrace(Trace, Modes[ModeIndex], 60.0);
+        r64 MovingMean = GetMean(Errors.Moving);
+        printf("    %-8s %14.2f %6.2f %6.1f %18.2f %6.1f %17u %8.0f ns\n", ModeNames[ModeIndex],
+               MovingMean, GetPercentile(Errors.Moving, 95), GetPercentile(Errors.Moving, 100),
+               GetMean(Errors.AfterStop), GetPercentile(Errors.AfterStop, 100), Errors.LateOvershoots, Errors.NanosecondsPerFrame);
+
+        if (Modes[ModeIndex] == CursorPrediction_None)
+        {
+            UnpredictedMoving = MovingMean;
+        }
+        else if (MovingMean > UnpredictedMoving)
+        {
+            printf("    FAILED: %s prediction lags more than not predicting\n", ModeNames[ModeIndex]);
+            Passed = false;
+        }
+
+        if (Errors.LateOvershoots)
+        {
+            printf("    FAILED: %s prediction still overshoots after the cursor stopped\n", ModeNames[ModeIndex]);
+            Passed = false;
+        }
+    }
+
+    return Passed;
+}
+
+int main(int ArgumentCount, char **Arguments)
+{
+    b32 Passed = true;
+    if (ArgumentCount > 1)
+    {
+        for (i32 ArgumentIndex = 1; ArgumentIndex < ArgumentCount; ++ArgumentIndex)
+        {
+            cursor_trace Trace;
+            if (!LoadTrace(Arguments[ArgumentIndex], &Trace))
+            {
+                printf("Couldn't load the trace %s\n", Arguments[ArgumentIndex]);
+                return 1;
+            }
+            Passed = ReportTrace(&Trace) && Passed;
+        }
+    }
+    else
+    {
+        cursor_trace Slow = MakeSyntheticTrace(125.0, 42);
+        cursor_trace Fast = MakeSyntheticTrace(1000.0, 42);
+        Passed = ReportTrace(&Slow) && Passed;
+        Passed = ReportTrace(&Fast) && Passed;
+    }
+
+    return Passed ? 0 : 1;
+}
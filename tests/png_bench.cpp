@@ -0,0 +1,101 @@
+/*
+    ==========================================================================
+    File: png_bench.cpp
+    Date: 18/10/2026
+    ==========================================================================
+
+    Times the PNG encoder on an 8K (7680x4320) frame that looks like an exported layout, on one
+    thread and on every hardware thread, and reports how much memory the encoder holds while it
+    runs. Built and run by tests/build.sh -bench.
+*/
+
+#include "pcg_png.h"
+#include <stdio.h>
+#include <chrono>
+
+internal b32 CountBytes(void *Context, const u8 *Data, u32 Size)
+{
+    (void)Data;
+    *(u64 *)Context += Size;
+    return true;
+}
+
+/// A dark background with a selection, its dashed edges, a measurement line and a label.
+internal void MakeLayoutRow(u8 *Row, u32 Width, u32 Height, u32 Y)
+{
+    for (u32 X = 0; X < Width; ++X)
+    {
+        u8 Red = 20;
+        u8 Green = 20;
+        u8 Blue = 20;
+        if (X > Width / 4 && X < 3 * Width / 4 && Y > Height / 4 && Y < 3 * Height / 4)
+        {
+            Red = Green = Blue = 50;
+        }
+        if ((X == Width / 4 || X == 3 * Width / 4) && Y > Height / 4 && Y < 3 * Height / 4 && (Y / 16) % 2)
+        {
+            Red = 79;
+            Green = 223;
+            Blue = 78;
+        }
+        if (Y == Height / 2 && (X / 24) % 2)
+        {
+            Red = Green = Blue = 255;
+        }
+        if (Y + 12 > Height / 2 && Y < Height / 2 + 12 && X > Width / 8 && X < Width / 8 + 116 && ((X * 7 + Y * 13) % 5) == 0)
+        {
+            Red = Green = Blue = 255;
+        }
+
+        Row[X * 3 + 0] = Red;
+        Row[X * 3 + 1] = Green;
+        Row[X * 3 + 2] = Blue;
+    }
+}
+
+internal void TimeEncode(u32 ThreadCount)
+{
+    const u32 Width = 7680;
+    const u32 Height = 4320;
+
+    // NOTE: Rows are generated up front so only the encoder is timed
+    std::vector<u8> Pixels((size_t)Width * Height * 3);
+    for (u32 Y = 0; Y < Height; ++Y)
+    {
+        MakeLayoutRow(&Pixels[(size_t)Y * Width * 3], Width, Height, Y);
+    }
+
+    u64 FileSize = 0;
+    png_encoder Encoder = { };
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    b32 Encoded = BeginPngEncode(&Encoder, Width, Height, 3, CountBytes, &FileSize, ThreadCount);
+    for (u32 Y = 0; Encoded && Y < Height; ++Y)
+    {
+        Encoded = WritePngRow(&Encoder, &Pixels[(size_t)Y * Width * 3]);
+    }
+
+    // NOTE: Everything the encoder allocated, measured before EndPngEncode frees it
+    size_t EncoderBytes = Encoder.PendingRows.capacity();
+    for (u32 JobIndex = 0; JobIndex < Encoder.Jobs.size(); ++JobIndex)
+    {
+        const png_job *Job = &Encoder.Jobs[JobIndex];
+        EncoderBytes += Job->Filtered.capacity() + Job->Scratch.capacity() + Job->Chunk.capacity();
+    }
+    u32 UsedThreads = (u32)Encoder.Jobs.size(); // NOTE: One job per thread
+
+    Encoded = EndPngEncode(&Encoder) && Encoded;
+    std::chrono::steady_clock::time_point End = std::chrono::steady_clock::now();
+
+    r64 Milliseconds = std::chrono::duration<r64, std::milli>(End - Start).count();
+    printf("%u x %u, %u thread(s): %7.1f ms, %6.1f MB/s, %llu bytes (%.2f%% of raw), encoder buffers %.1f MB%s\n",
+           Width, Height, UsedThreads, Milliseconds, (r64)Pixels.size() / (Milliseconds * 1000.0), (unsigned long long)FileSize,
+           100.0 * (r64)FileSize / (r64)Pixels.size(), (r64)EncoderBytes / (1024.0 * 1024.0), Encoded ? "" : " FAILED");
+}
+
+int main()
+{
+    TimeEncode(1);
+    TimeEncode(0);
+
+    return 0;
+}
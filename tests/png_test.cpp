@@ -0,0 +1,274 @@
+/*
+    ==========================================================================
+    File: png_test.cpp
+    Date: 18/10/2026
+    ==========================================================================
+
+    Checks the PNG encoder by decoding its output with zlib and a reference unfilter, and
+    comparing the pixels bit for bit. Covers RGB and RGBA, single and multi-threaded encodes,
+    and images large enough to be split over several jobs. Also checks the SSE2 filters
+    against the scalar ones. Built and run by tests/build.sh.
+*/
+
+#include "pcg_png.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <zlib.h>
+
+internal b32 AppendToBuffer(void *Context, const u8 *Data, u32 Size)
+{
+    std::vector<u8> *Buffer = (std::vector<u8> *)Context;
+    Buffer->insert(Buffer->end(), Data, Data + Size);
+    return true;
+}
+
+internal u32 ReadU32BigEndian(const u8 *Data)
+{
+    return ((u32)Data[0] << 24) | ((u32)Data[1] << 16) | ((u32)Data[2] << 8) | (u32)Data[3];
+}
+
+/// Fills a row that looks like an exported layout (flat background, selection, dashed lines and text),
+/// or noise, which doesn't compress and exercises the stored block fallback.
+internal void MakeTestRow(u8 *Row, u32 Width, u32 Height, u32 Y, u32 BytesPerPixel, b32 IsNoise, std::mt19937 *Random)
+{
+    for (u32 X = 0; X < Width; ++X)
+    {
+        u8 Red = 20;
+        u8 Green = 20;
+        u8 Blue = 20;
+        if (IsNoise)
+        {
+            Red = (u8)(*Random)();
+            Green = (u8)(*Random)();
+            Blue = (u8)(*Random)();
+        }
+        else
+        {
+            if (X > Width / 4 && X < 3 * Width / 4 && Y > Height / 4 && Y < 3 * Height / 4)
+            {
+                Red = Green = Blue = 50;
+            }
+            if ((X == Width / 4 || X == 3 * Width / 4) && Y > Height / 4 && Y < 3 * Height / 4 && (Y / 16) % 2)
+            {
+                Red = 79;
+                Green = 223;
+                Blue = 78;
+            }
+            if (Y == Height / 2 && (X / 24) % 2)
+            {
+                Red = Green = Blue = 255;
+            }
+            if (Y + 12 > Height / 2 && Y < Height / 2 + 12 && X > Width / 8 && X < Width / 8 + 116 && ((X * 7 + Y * 13) % 5) == 0)
+            {
+                Red = Green = Blue = 255;
+            }
+        }
+
+        Row[X * BytesPerPixel + 0] = Red;
+        Row[X * BytesPerPixel + 1] = Green;
+        Row[X * BytesPerPixel + 2] = Blue;
+        if (BytesPerPixel == 4)
+        {
+            Row[X * BytesPerPixel + 3] = (u8)(255 - (X & 15));
+        }
+    }
+}
+
+/// Decodes a PNG produced by the encoder (8-bit RGB/RGBA, no interlacing) into tightly packed rows.
+/// Returns false if the file is malformed in any way.
+internal b32 DecodeTestPng(const std::vector<u8> &File, u32 *Width, u32 *Height, u32 *BytesPerPixel, std::vector<u8> *Pixels)
+{
+    const u8 Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (File.size() < 8 || memcmp(File.data(), Signature, 8) != 0)
+    {
+        return false;
+    }
+
+    std::vector<u8> Compressed;
+    b32 SawHeader = false;
+    b32 SawEnd = false;
+    size_t Offset = 8;
+    while (!SawEnd)
+    {
+        if (Offset + 12 > File.size())
+        {
+            return false;
+        }
+        u32 Length = ReadU32BigEndian(&File[Offset]);
+        if (Offset + 12 + Length > File.size())
+        {
+            return false;
+        }
+        const u8 *Type = &File[Offset + 4];
+        const u8 *Data = &File[Offset + 8];
+        if ((u32)crc32(0, Type, Length + 4) != ReadU32BigEndian(Data + Length))
+        {
+            return false;
+        }
+
+        if (memcmp(Type, "IHDR", 4) == 0 && Length == 13)
+        {
+            *Width = ReadU32BigEndian(Data);
+            *Height = ReadU32BigEndian(Data + 4);
+            if (Data[8] != 8 || (Data[9] != 2 && Data[9] != 6) || Data[10] || Data[11] || Data[12])
+            {
+                return false;
+            }
+            *BytesPerPixel = (Data[9] == 6) ? 4 : 3;
+            SawHeader = true;
+        }
+        else if (memcmp(Type, "IDAT", 4) == 0)
+        {
+            Compressed.insert(Compressed.end(), Data, Data + Length);
+        }
+        else if (memcmp(Type, "IEND", 4) == 0)
+        {
+            SawEnd = true;
+        }
+        Offset += 12 + Length;
+    }
+    if (!SawHeader || Offset != File.size())
+    {
+        return false;
+    }
+
+    u32 RowBytes = *Width * *BytesPerPixel;
+    std::vector<u8> Filtered((size_t)(RowBytes + 1) * *Height);
+    uLongf FilteredSize = (uLongf)Filtered.size();
+    if (uncompress(Filtered.data(), &FilteredSize, Compressed.data(), (uLong)Compressed.size()) != Z_OK ||
+        FilteredSize != Filtered.size())
+    {
+        return false;
+    }
+
+    // NOTE: Reference unfilter, straight from the spec
+    Pixels->assign((size_t)RowBytes * *Height, 0);
+    for (u32 Y = 0; Y < *Height; ++Y)
+    {
+        const u8 *In = &Filtered[(size_t)Y * (RowBytes + 1)];
+        u8 *Out = Pixels->data() + (size_t)Y * RowBytes;
+        const u8 *Up = Y ? Out - RowBytes : 0;
+        for (u32 Index = 0; Index < RowBytes; ++Index)
+        {
+            i32 A = (Index >= *BytesPerPixel) ? Out[Index - *BytesPerPixel] : 0;
+            i32 B = Up ? Up[Index] : 0;
+            i32 C = (Up && Index >= *BytesPerPixel) ? Up[Index - *BytesPerPixel] : 0;
+            i32 Predicted = 0;
+            switch (In[0])
+            {
+                case PngFilter_None: Predicted = 0; break;
+                case PngFilter_Sub: Predicted = A; break;
+                case PngFilter_Up: Predicted = B; break;
+                case PngFilter_Average: Predicted = (A + B) / 2; break;
+                case PngFilter_Paeth:
+                {
+                    i32 P = A + B - C;
+                    i32 PA = abs(P - A);
+                    i32 PB = abs(P - B);
+                    i32 PC = abs(P - C);
+                    Predicted = (PA <= PB && PA <= PC) ? A : (PB <= PC) ? B : C;
+                }
+                break;
+                default: return false;
+            }
+            Out[Index] = (u8)(In[1 + Index] + Predicted);
+        }
+    }
+
+    return true;
+}
+
+/// Encodes an image and checks that it decodes back to the same pixels.
+internal b32 TestRoundTrip(u32 Width, u32 Height, u32 BytesPerPixel, b32 IsNoise, u32 ThreadCount)
+{
+    std::mt19937 Random(Width * 31 + Height);
+    std::vector<u8> Source((size_t)Width * Height * BytesPerPixel);
+    for (u32 Y = 0; Y < Height; ++Y)
+    {
+        MakeTestRow(&Source[(size_t)Y * Width * BytesPerPixel], Width, Height, Y, BytesPerPixel, IsNoise, &Random);
+    }
+
+    std::vector<u8> File;
+    png_encoder Encoder = { };
+    b32 Encoded = BeginPngEncode(&Encoder, Width, Height, BytesPerPixel, AppendToBuffer, &File, ThreadCount);
+    for (u32 Y = 0; Encoded && Y < Height; ++Y)
+    {
+        Encoded = WritePngRow(&Encoder, &Source[(size_t)Y * Width * BytesPerPixel]);
+    }
+    Encoded = EndPngEncode(&Encoder) && Encoded;
+
+    u32 DecodedWidth = 0;
+    u32 DecodedHeight = 0;
+    u32 DecodedBytesPerPixel = 0;
+    std::vector<u8> Decoded;
+    b32 Passed = Encoded && DecodeTestPng(File, &DecodedWidth, &DecodedHeight, &DecodedBytesPerPixel, &Decoded) &&
+                 DecodedWidth == Width && DecodedHeight == Height && DecodedBytesPerPixel == BytesPerPixel &&
+                 Decoded == Source;
+
+    char Threads[16] = "all";
+    if (ThreadCount)
+    {
+        snprintf(Threads, sizeof(Threads), "%u", ThreadCount);
+    }
+    printf("%5u x %-5u %s %-6s threads %-3s: %8zu bytes, %s\n", Width, Height, (BytesPerPixel == 4) ? "RGBA" : "RGB ",
+           IsNoise ? "noise" : "layout", Threads, File.size(), Passed ? "ok" : "FAILED");
+    return Passed;
+}
+
+/// Checks that the SSE2 filters produce the same filtered bytes and costs as the scalar ones.
+internal u32 TestFilters()
+{
+    u32 Mismatches = 0;
+#if PCG_PNG_SSE2
+    std::mt19937 Random(3);
+    for (u32 Test = 0; Test < 2000; ++Test)
+    {
+        u32 BytesPerPixel = 3 + (Test & 1);
+        u32 Size = (Random() % 200 + 1) * BytesPerPixel;
+        u32 Range = (Test % 3) ? 256 : 4; // NOTE: Small values make ties between the filters likely
+        std::vector<u8> Row(PngRowPadding + Size);
+        std::vector<u8> PreviousRow(PngRowPadding + Size);
+        for (u32 Index = 0; Index < Size; ++Index)
+        {
+            Row[PngRowPadding + Index] = (u8)(Random() % Range);
+            PreviousRow[PngRowPadding + Index] = (u8)(Random() % Range);
+        }
+
+        std::vector<u8> ScalarOut(4 * (size_t)Size);
+        std::vector<u8> SSE2Out(4 * (size_t)Size);
+        u8 *ScalarFiltered[PngFilter_Count] = { &Row[PngRowPadding], &ScalarOut[0], &ScalarOut[Size], &ScalarOut[2 * Size], &ScalarOut[3 * Size] };
+        u8 *SSE2Filtered[PngFilter_Count] = { &Row[PngRowPadding], &SSE2Out[0], &SSE2Out[Size], &SSE2Out[2 * Size], &SSE2Out[3 * Size] };
+        u64 ScalarCosts[PngFilter_Count] = { };
+        u64 SSE2Costs[PngFilter_Count] = { };
+
+        FilterPngBytesScalar(&Row[PngRowPadding], &PreviousRow[PngRowPadding], 0, Size, BytesPerPixel, ScalarFiltered, ScalarCosts);
+        u32 Done = FilterPngBytesSSE2(&Row[PngRowPadding], &PreviousRow[PngRowPadding], Size, BytesPerPixel, SSE2Filtered, SSE2Costs);
+        FilterPngBytesScalar(&Row[PngRowPadding], &PreviousRow[PngRowPadding], Done, Size, BytesPerPixel, SSE2Filtered, SSE2Costs);
+
+        if (ScalarOut != SSE2Out || memcmp(ScalarCosts, SSE2Costs, sizeof(ScalarCosts)) != 0)
+        {
+            ++Mismatches;
+        }
+    }
+    printf("SSE2 filters: 2000 rows, %u mismatches\n", Mismatches);
+#else
+    printf("SSE2 filters: not available on this target\n");
+#endif
+    return Mismatches;
+}
+
+int main()
+{
+    b32 Passed = (TestFilters() == 0);
+
+    Passed = TestRoundTrip(1, 1, 3, false, 1) && Passed;
+    Passed = TestRoundTrip(5, 3, 4, true, 2) && Passed;
+    Passed = TestRoundTrip(300, 200, 3, false, 3) && Passed;
+    Passed = TestRoundTrip(1000, 1500, 4, true, 4) && Passed; // NOTE: Several jobs per flush, stored blocks
+    Passed = TestRoundTrip(2560, 1440, 3, false, 1) && Passed;
+    Passed = TestRoundTrip(2560, 1440, 3, false, 0) && Passed;
+    Passed = TestRoundTrip(7680, 300, 3, false, 5) && Passed; // NOTE: One row per job is over 22 KB
+
+    return Passed ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/*
+    ==========================================================================
+    File: window_index_test.cpp
+    Date: 18/10/2026
+    ==========================================================================
+
+    Checks the window index against a brute-force hit-test over synthetic window sets, checks
+    that snapshot updates keep the z-order they're given, and times the index on a large
+    desktop. Built and run by tests/build.sh.
+*/
+
+#include "pcg_window_index.h"
+#include <stdio.h>
+#include <chrono>
+#include <random>
+
+/// The front-most window containing the point, found the slow way.
+internal i32 BruteForceHitTest(const std::vector<window_entry> &Entries, i32 X, i32 Y)
+{
+    for (u32 EntryIndex = 0; EntryIndex < Entries.size(); ++EntryIndex)
+    {
+        const window_entry *Entry = &Entries[EntryIndex];
+        if (!IsWindowEntryEmpty(Entry) &&
+            X >= Entry->Left && X < Entry->Right && Y >= Entry->Top && Y < Entry->Bottom)
+        {
+            return (i32)EntryIndex;
+        }
+    }
+
+    return -1;
+}
+
+internal window_entry RandomWindow(std::mt19937 *Random, u64 Id, i32 Range, i32 MaxSize)
+{
+    window_entry Entry;
+    Entry.Id = Id;
+    Entry.Left = (i32)((*Random)() % (u32)Range) - Range / 4;
+    Entry.Top = (i32)((*Random)() % (u32)Range) - Range / 4;
+    Entry.Right = Entry.Left + (i32)((*Random)() % (u32)MaxSize); // NOTE: Includes some empty windows
+    Entry.Bottom = Entry.Top + (i32)((*Random)() % (u32)MaxSize);
+    return Entry;
+}
+
+/// Picks the window to place a window behind: none (the front), a window in the snapshot, or one that isn't.
+internal u64 RandomAboveId(std::mt19937 *Random, u64 MaxId)
+{
+    return ((*Random)() % 4 == 0) ? 0 : 1 + (*Random)() % (MaxId + 4);
+}
+
+/// Compares the index against the brute-force hit-test on every point of a grid covering the windows.
+internal u64 TestHitTests(u64 *ProbeCount)
+{
+    u64 Mismatches = 0;
+    std::mt19937 Random(1);
+    for (u32 Set = 0; Set < 250; ++Set)
+    {
+        window_snapshot Snapshot = { };
+        u32 WindowCount = Random() % 40;
+        for (u32 WindowIndex = 0; WindowIndex < WindowCount; ++WindowIndex)
+        {
+            UpdateSnapshotWindow(&Snapshot, RandomWindow(&Random, 1 + WindowIndex, 200, 120), RandomAboveId(&Random, WindowCount));
+        }
+
+        // NOTE: Churn the snapshot the same way the window events do
+        for (u32 Change = 0; Change < 8; ++Change)
+        {
+            u64 Id = 1 + Random() % (WindowCount + 4);
+            if (Random() % 3 == 0)
+            {
+                RemoveSnapshotWindow(&Snapshot, Id);
+            }
+            else
+            {
+                UpdateSnapshotWindow(&Snapshot, RandomWindow(&Random, Id, 200, 100), RandomAboveId(&Random, WindowCount));
+            }
+        }
+
+        window_index Index;
+        BuildWindowIndex(&Index, Snapshot.Entries.data(), (u32)Snapshot.Entries.size());
+        for (i32 Y = -60; Y < 260; ++Y)
+        {
+            for (i32 X = -60; X < 260; ++X)
+            {
+                if (WindowIndexHitTest(&Index, X, Y) != BruteForceHitTest(Snapshot.Entries, X, Y))
+                {
+                    ++Mismatches;
+                }
+                ++*ProbeCount;
+            }
+        }
+    }
+
+    return Mismatches;
+}
+
+/// Checks that UpdateSnapshotWindow places windows where it's told to, against a plain list of IDs.
+internal u64 TestZOrder(u64 *UpdateCount)
+{
+    u64 Mismatches = 0;
+    std::mt19937 Random(2);
+    for (u32 Run = 0; Run < 2000; ++Run)
+    {
+        window_snapshot Snapshot = { };
+        std::vector<u64> Expected;
+        for (u32 Change = 0; Change < 60; ++Change)
+        {
+            u64 Id = 1 + Random() % 24;
+            u64 AboveId = RandomAboveId(&Random, 24);
+            if (AboveId == Id)
+            {
+                AboveId = 0; // NOTE: A window is never above itself
+            }
+            window_entry Entry = RandomWindow(&Random, Id, 200, 100);
+
+            std::vector<u64>::iterator Existing = std::find(Expected.begin(), Expected.end(), Id);
+            if (Existing != Expected.end())
+            {
+                Expected.erase(Existing);
+            }
+            if (!IsWindowEntryEmpty(&Entry))
+            {
+                std::vector<u64>::iterator Above = std::find(Expected.begin(), Expected.end(), AboveId);
+                Expected.insert((Above == Expected.end()) ? Expected.begin() : Above + 1, Id);
+            }
+
+            UpdateSnapshotWindow(&Snapshot, Entry, AboveId);
+            ++*UpdateCount;
+
+            b32 Matches = (Snapshot.Entries.size() == Expected.size());
+            for (u32 EntryIndex = 0; Matches && EntryIndex < Expected.size(); ++EntryIndex)
+            {
+                Matches = (Snapshot.Entries[EntryIndex].Id == Expected[EntryIndex]);
+            }
+            if (!Matches)
+            {
+                ++Mismatches;
+            }
+        }
+    }
+
+    return Mismatches;
+}
+
+internal void TimeLargeDesktop()
+{
+    std::mt19937 Random(3);
+    std::vector<window_entry> Entries;
+    for (u32 WindowIndex = 0; WindowIndex < 300; ++WindowIndex)
+    {
+        window_entry Entry;
+        Entry.Id = 1 + WindowIndex;
+        Entry.Left = (i32)(Random() % 7000);
+        Entry.Top = (i32)(Random() % 2000);
+        Entry.Right = Entry.Left + 200 + (i32)(Random() % 1500);
+        Entry.Bottom = Entry.Top + 150 + (i32)(Random() % 1000);
+        Entries.push_back(Entry);
+    }
+
+    window_index Index;
+    std::chrono::steady_clock::time_point BuildStart = std::chrono::steady_clock::now();
+    BuildWindowIndex(&Index, Entries.data(), (u32)Entries.size());
+    std::chrono::steady_clock::time_point BuildEnd = std::chrono::steady_clock::now();
+
+    const u32 ProbeCount = 1000000;
+    i64 Checksum = 0;
+    for (u32 Probe = 0; Probe < ProbeCount; ++Probe)
+    {
+        Checksum += WindowIndexHitTest(&Index, (i32)(Random() % 8000), (i32)(Random() % 3000));
+    }
+    std::chrono::steady_clock::time_point HitTestEnd = std::chrono::steady_clock::now();
+
+    printf("300 windows: build %.2f ms (%zu slabs, %zu spans), hit-test %.1f ns (checksum %lld)\n",
+           std::chrono::duration<r64, std::milli>(BuildEnd - BuildStart).count(), Index.SlabX.size(), Index.SpanY.size(),
+           std::chrono::duration<r64, std::nano>(HitTestEnd - BuildEnd).count() / ProbeCount, (long long)Checksum);
+}
+
+int main()
+{
+    u64 ProbeCount = 0;
+    u64 HitTestMismatches = TestHitTests(&ProbeCount);
+    printf("Hit-tests: %llu probes, %llu mismatches\n", (unsigned long long)ProbeCount, (unsigned long long)HitTestMismatches);
+
+    u64 UpdateCount = 0;
+    u64 ZOrderMismatches = TestZOrder(&UpdateCount);
+    printf("Z-order: %llu updates, %llu mismatches\n", (unsigned long long)UpdateCount, (unsigned long long)ZOrderMismatches);
+
+    TimeLargeDesktop();
+
+    return (HitTestMismatches || ZOrderMismatches) ? 1 : 0;
+}
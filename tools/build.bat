@@ -15,14 +15,16 @@ SET Separator=▰  ▰  ▰  ▰  ▰  ▰  ▰  ▰  ▰  ▰  ▰  ▰  ▰  
 @ECHO.
 @ECHO OFF
 
-SET ProgramVersion=_v1_2
-SET CommonLibraries=user32.lib Gdi32.lib winmm.lib Gdiplus.lib uxtheme.lib
+SET ProgramVersion=_v1_3
+SET CommonLibraries=user32.lib Gdi32.lib winmm.lib Gdiplus.lib uxtheme.lib dwmapi.lib comdlg32.lib
 SET CommonDisableWarnings=-wd4458 -wd4456
 
 if "%~1"=="-debug" goto :BUILD_DEBUG
 if "%~1"=="/debug" goto :BUILD_DEBUG
 if "%~1"=="-release" goto :BUILD_RELEASE
 if "%~1"=="/release" goto :BUILD_RELEASE
+if "%~1"=="-variants" goto :BUILD_VARIANTS
+if "%~1"=="/variants" goto :BUILD_VARIANTS
 if "%~1"=="/-h" goto :HELP
 if "%~1"=="-h" goto :HELP
 goto :ERROR
@@ -59,9 +61,40 @@ call ..\..\tools\util\PrintSuccess
 POPD
 GOTO :END
 
+:BUILD_VARIANTS
+IF NOT EXIST ..\build MKDIR ..\build
+IF NOT EXIST ..\build\variants MKDIR ..\build\variants
+PUSHD ..\build\variants
+DEL * /Q > nul 2>&1
+SET VariantCompilerFlags=-nologo -std:c++17 -EHa- -O2 -Oi -WX -W4 %CommonDisableWarnings% -FC
+SET VariantsFailed=0
+@ECHO [95m%Separator%
+@ECHO    Building Variants...
+@ECHO %Separator%[0m
+@ECHO.
+@REM NOTE: Build every combination of the variant flags, so none of them rot unnoticed
+FOR %%I IN (0 1) DO FOR %%V IN (0 1) DO FOR %%B IN (0 1) DO FOR %%O IN (0 1) DO (
+    @ECHO PCG_INTERNAL=%%I PCG_ATTEMPT_VSYNC=%%V PCG_BUFFERED_PAINT=%%B PCG_DEBUG_OVERLAY=%%O
+    cl %VariantCompilerFlags% -DPCG_INTERNAL=%%I -DPCG_ATTEMPT_VSYNC=%%V -DPCG_BUFFERED_PAINT=%%B -DPCG_DEBUG_OVERLAY=%%O -FePcgCamUtility%ProgramVersion%_%%I%%V%%B%%O ..\..\source\win32_pcg_cam.cpp /link -incremental:no -opt:ref %CommonLibraries%
+    IF ERRORLEVEL 1 SET VariantsFailed=1
+)
+@REM NOTE: The benchmark build instantiates the variants in one executable and times how long each takes to paint a frame
+@REM (pacing only decides how often frames are painted, so it isn't benchmarked)
+cl %VariantCompilerFlags% -DPCG_BENCHMARK=1 -FePcgCamBenchmark%ProgramVersion% ..\..\source\win32_pcg_cam.cpp /link -incremental:no -opt:ref %CommonLibraries%
+IF ERRORLEVEL 1 SET VariantsFailed=1
+IF !VariantsFailed! equ 0 (
+    START /WAIT PcgCamBenchmark%ProgramVersion%.exe
+    @ECHO.
+    TYPE variants_bench.txt
+)
+CMD /C EXIT !VariantsFailed!
+call ..\..\tools\util\PrintSuccess
+POPD
+GOTO :END
+
 :HELP
 @REM // TODO: Better handling!
-@ECHO Usage: Build -[debug/release]
+@ECHO Usage: Build -[debug/release/variants]
 @ECHO.
 @ECHO OFF
 GOTO :END